@@ -4,10 +4,39 @@
 #include <Zivid/HandEye/Detector.h>
 #include <Zivid/HandEye/Pose.h>
 
+#include <clipp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
 
 namespace
 {
+    using HighResClock = std::chrono::high_resolution_clock;
+
+    // 运行模式
+    enum class Mode
+    {
+        interactive,
+        record,
+        offline,
+        select
+    };
+
 	// 命令类型
     enum class CommandType
     {
@@ -52,7 +81,7 @@ namespace
 	 *		- [in]index: 位姿的标签;
 	 * 返回值：机器人的位姿；
 	 */
-    Zivid::HandEye::Pose enterRobotPose(size_t index)
+    Zivid::Matrix4d enterRobotPose(size_t index)
     {
 		// 输入带id的位姿(用16个空格分开的值描述4x4行-主矩阵的行)
         std::cout << "Enter pose with id (a line with 16 space separated values describing 4x4 row-major matrix) : "
@@ -91,22 +120,305 @@ namespace
 
         return frame;
     }
-} // namespace
 
-int main()
-{
-    try
+    double toMilliseconds(const HighResClock::duration &duration)
     {
-        Zivid::Application zivid;
+        return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+    }
+
+    /* 函数意义: 数据集中位姿文件的路径, 例如 <dataset>/frame_03.zdf 和 <dataset>/pose_03.txt;
+     * 参数意义：
+     *      - [in]datasetDirectory: 数据集目录;
+     *      - [in]prefix: 文件名前缀, "frame" 或 "pose";
+     *      - [in]poseId: 位姿的标签;
+     *      - [in]extension: 文件扩展名;
+     * 返回值：文件路径；
+     */
+    std::string datasetFilePath(const std::string &datasetDirectory,
+                                const std::string &prefix,
+                                const size_t poseId,
+                                const std::string &extension)
+    {
+        std::ostringstream path;
+        path << datasetDirectory << "/" << prefix << "_" << std::setw(2) << std::setfill('0') << poseId << extension;
+        return path.str();
+    }
+
+    bool fileExists(const std::string &path)
+    {
+        return std::ifstream(path).good();
+    }
+
+    /* 函数意义: 保存机器人位姿; 文件为4行, 每行4个空格分开的值 (4x4行-主矩阵);
+     */
+    void saveRobotPose(const Zivid::Matrix4d &robotPose, const std::string &path)
+    {
+        std::ofstream file(path);
+        file << std::setprecision(17);
+        for(size_t row = 0; row < 4; row++)
+        {
+            for(size_t col = 0; col < 4; col++)
+            {
+                file << robotPose(row, col) << (col == 3 ? "\n" : " ");
+            }
+        }
+        if(!file)
+        {
+            throw std::runtime_error("Could not write robot pose to " + path);
+        }
+    }
+
+    /* 函数意义: 读取由saveRobotPose保存的机器人位姿;
+     */
+    Zivid::Matrix4d loadRobotPose(const std::string &path)
+    {
+        std::ifstream file(path);
+        if(!file)
+        {
+            throw std::runtime_error("Could not open " + path);
+        }
+        double element{ 0 };
+        std::vector<double> transformElements;
+        while(transformElements.size() < 16 && file >> element)
+        {
+            transformElements.emplace_back(element);
+        }
+        if(transformElements.size() != 16)
+        {
+            throw std::runtime_error("Expected 16 values (4x4 row-major matrix) in " + path);
+        }
+        return Zivid::Matrix4d{ transformElements.cbegin(), transformElements.cend() };
+    }
+
+    // 数据集中检测成功的位姿
+    struct DetectedPose
+    {
+        size_t poseId;
+        Zivid::HandEye::CalibrationInput input;
+    };
+
+    // 单个位姿在流水线中各阶段的耗时
+    struct PoseTiming
+    {
+        size_t poseId;
+        HighResClock::duration queueDuration;
+        HighResClock::duration captureDuration;
+        HighResClock::duration detectionDuration;
+        bool detected;
+    };
+
+    /* 类意义: 后台标定流水线; 拍摄线程依次采集棋盘格图像, 检测线程依次检测棋盘格特征点;
+     *      - submit()返回的future在图像采集完成后就绪, 此时即可移动机器人到下一个位姿,
+     *        而上一帧的特征点检测仍在后台进行, 下一帧的拍摄也不必等待检测完成;
+     *      - 检测结果按提交顺序收集, 检测失败由检测线程异步报告;
+     *      - 相机只在拍摄线程中使用;
+     *      - datasetDirectory不为空时, 每一帧及其位姿都由检测线程保存到该目录, 供离线标定使用;
+     */
+    class CalibrationPipeline
+    {
+    public:
+        CalibrationPipeline(Zivid::Camera &camera, std::string datasetDirectory)
+            : m_camera(camera)
+            , m_datasetDirectory(std::move(datasetDirectory))
+            , m_submissionsFinished(false)
+            , m_capturesFinished(false)
+            , m_captureWorker(&CalibrationPipeline::runCaptures, this)
+            , m_detectionWorker(&CalibrationPipeline::runDetections, this)
+        {}
+
+        CalibrationPipeline(const CalibrationPipeline &) = delete;
+        CalibrationPipeline &operator=(const CalibrationPipeline &) = delete;
+
+        ~CalibrationPipeline()
+        {
+            if(m_captureWorker.joinable())
+            {
+                finish();
+            }
+        }
+
+        std::future<void> submit(const size_t poseId, const Zivid::Matrix4d &robotPose)
+        {
+            CaptureJob job{ poseId, robotPose, HighResClock::now(), std::promise<void>{} };
+            auto captured = job.captured.get_future();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_captureJobs.push_back(std::move(job));
+            }
+            m_captureJobAvailable.notify_one();
+            return captured;
+        }
+
+        std::vector<Zivid::HandEye::CalibrationInput> finish()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_submissionsFinished = true;
+            }
+            m_captureJobAvailable.notify_one();
+            m_captureWorker.join();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_capturesFinished = true;
+            }
+            m_detectionJobAvailable.notify_one();
+            m_detectionWorker.join();
+            return m_inputs;
+        }
 
-		// 连接相机
-        std::cout << "Connecting to camera..." << std::endl;
-        auto camera{ zivid.connectCamera() };
+        // 只能在finish()之后调用
+        const std::vector<PoseTiming> &timings() const
+        {
+            return m_timings;
+        }
 
+    private:
+        struct CaptureJob
+        {
+            size_t poseId;
+            Zivid::Matrix4d robotPose;
+            HighResClock::time_point submitTime;
+            std::promise<void> captured;
+        };
+
+        struct DetectionJob
+        {
+            size_t poseId;
+            Zivid::Matrix4d robotPose;
+            Zivid::Frame frame;
+            HighResClock::duration queueDuration;
+            HighResClock::duration captureDuration;
+        };
+
+        void runCaptures()
+        {
+            while(true)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_captureJobAvailable.wait(lock, [this] { return !m_captureJobs.empty() || m_submissionsFinished; });
+                if(m_captureJobs.empty())
+                {
+                    return;
+                }
+                auto job = std::move(m_captureJobs.front());
+                m_captureJobs.pop_front();
+                lock.unlock();
+
+                capture(job);
+            }
+        }
+
+        void runDetections()
+        {
+            while(true)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_detectionJobAvailable.wait(lock, [this] { return !m_detectionJobs.empty() || m_capturesFinished; });
+                if(m_detectionJobs.empty())
+                {
+                    return;
+                }
+                auto job = std::move(m_detectionJobs.front());
+                m_detectionJobs.pop_front();
+                lock.unlock();
+
+                detect(job);
+            }
+        }
+
+        void capture(CaptureJob &job)
+        {
+            try
+            {
+                const auto beforeCapture = HighResClock::now();
+                const auto frame = acquireCheckerboardFrame(m_camera);
+                const auto afterCapture = HighResClock::now();
+                job.captured.set_value();
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_detectionJobs.push_back(DetectionJob{
+                        job.poseId, job.robotPose, frame, beforeCapture - job.submitTime, afterCapture - beforeCapture });
+                }
+                m_detectionJobAvailable.notify_one();
+            }
+            catch(const std::exception &)
+            {
+                job.captured.set_exception(std::current_exception());
+            }
+        }
+
+        void detect(DetectionJob &job)
+        {
+            PoseTiming timing{
+                job.poseId, job.queueDuration, job.captureDuration, HighResClock::duration::zero(), false
+            };
+            try
+            {
+                // 检测棋盘格的方形中心
+                const auto beforeDetection = HighResClock::now();
+                const auto result = Zivid::HandEye::detectFeaturePoints(job.frame.getPointCloud());
+                timing.detectionDuration = HighResClock::now() - beforeDetection;
+                if(result)
+                {
+                    std::cout << "Pose " << job.poseId << ": checkerboard square centers detected" << std::endl;
+                    m_inputs.emplace_back(
+                        Zivid::HandEye::CalibrationInput{ Zivid::HandEye::Pose{ job.robotPose }, result });
+                    timing.detected = true;
+                }
+                else
+                {
+                    std::cout << "Pose " << job.poseId << ": checkerboard detection FAILED" << std::endl;
+                }
+            }
+            catch(const std::exception &e)
+            {
+                std::cout << "Pose " << job.poseId << ": Error: " << Zivid::toString(e) << std::endl;
+            }
+            m_timings.push_back(timing);
+
+            // 检测之后再保存数据集; 保存失败 (例如磁盘已满) 只影响数据集, 不会丢弃已检测到的标定位姿
+            if(!m_datasetDirectory.empty())
+            {
+                try
+                {
+                    saveRobotPose(job.robotPose, datasetFilePath(m_datasetDirectory, "pose", job.poseId, ".txt"));
+                    job.frame.save(datasetFilePath(m_datasetDirectory, "frame", job.poseId, ".zdf"));
+                }
+                catch(const std::exception &e)
+                {
+                    std::cout << "Pose " << job.poseId << ": dataset not saved: " << Zivid::toString(e) << std::endl;
+                }
+            }
+        }
+
+        Zivid::Camera &m_camera;
+        const std::string m_datasetDirectory;
+        std::mutex m_mutex;
+        std::condition_variable m_captureJobAvailable;
+        std::condition_variable m_detectionJobAvailable;
+        std::deque<CaptureJob> m_captureJobs;
+        std::deque<DetectionJob> m_detectionJobs;
+        bool m_submissionsFinished;
+        bool m_capturesFinished;
+        std::vector<Zivid::HandEye::CalibrationInput> m_inputs;
+        std::vector<PoseTiming> m_timings;
+        std::thread m_captureWorker;
+        std::thread m_detectionWorker;
+    };
+    /* 函数意义: 交互式地输入机器人位姿并拍摄棋盘格, 直到输入标定指令;
+     * 参数意义：
+     *      - [in]camera: 已连接的相机;
+     *      - [in]datasetDirectory: 保存每一帧及其位姿的目录; 为空时不保存;
+     * 返回值：检测成功的标定输入, 按位姿顺序排列；
+     */
+    std::vector<Zivid::HandEye::CalibrationInput> collectCalibrationInput(Zivid::Camera &camera,
+                                                                          const std::string &datasetDirectory)
+    {
 		// 输入机器人的位姿
         size_t currPoseId{ 0 };
         bool calibrate{ false };
-        std::vector<Zivid::HandEye::CalibrationInput> input;
+        CalibrationPipeline pipeline(camera, datasetDirectory);
         do
         {
             switch(enterCommand())
@@ -117,21 +429,9 @@ int main()
                     {
                         const auto robotPose = enterRobotPose(currPoseId);
 
-                        const auto frame = acquireCheckerboardFrame(camera);
-
-						// 检测棋盘格的方形中心
-                        std::cout << "Detecting checkerboard square centers... " << std::flush;
-                        const auto result = Zivid::HandEye::detectFeaturePoints(frame.getPointCloud());
-                        if(result)
-                        {
-                            std::cout << "OK" << std::endl;
-                            input.emplace_back(Zivid::HandEye::CalibrationInput{ robotPose, result });
-                            currPoseId++;
-                        }
-                        else
-                        {
-                            std::cout << "FAILED" << std::endl;
-                        }
+                        // 等待图像采集完成; 特征点检测在后台进行, 此后即可移动机器人
+                        pipeline.submit(currPoseId, robotPose).get();
+                        currPoseId++;
                     }
                     catch(const std::exception &e)
                     {
@@ -153,12 +453,510 @@ int main()
             }
         } while(!calibrate);
 
+        std::cout << "Waiting for checkerboard detection to complete... " << std::endl;
+        return pipeline.finish();
+    }
+
+    /* 函数意义: 从文件或管道读取下一个机器人位姿的16个值 (4x4行-主矩阵);
+     *      - 每行可以是CSV (逗号分隔) 或空格分隔的数值, 也可以是YAML流式序列 (例如 "- [1, 0, 0, 0, ...]");
+     *      - 一个位姿可以写在一行中, 也可以跨多行 (例如每行4个值);
+     *      - 带YAML键的行只保留流式序列中的数值, 因此OpenCV矩阵格式 (例如robotTransform.yaml中的 "data: [ ... ]") 也可以读取,
+     *        而 "rows: 4" 等标量键值会被忽略;
+     *      - 空行, "#"后的注释以及包含非数值内容的行会被忽略;
+     * 参数意义：
+     *      - [in]input: 输入流;
+     *      - [out]elements: 位姿的16个值;
+     * 返回值：读到完整位姿时返回true, 输入结束时返回false；
+     */
+    bool readPoseElements(std::istream &input, std::vector<double> &elements)
+    {
+        elements.clear();
+        std::string line;
+        while(elements.size() < 16 && std::getline(input, line))
+        {
+            line = line.substr(0, line.find('#'));
+            const auto firstValue = line.find_first_not_of(" \t");
+            if(firstValue != std::string::npos && line.compare(firstValue, 2, "- ") == 0)
+            {
+                line.erase(0, firstValue + 2);
+            }
+            const auto keyEnd = line.find(':');
+            if(keyEnd != std::string::npos)
+            {
+                const auto valueBegin = line.find_first_not_of(" \t", keyEnd + 1);
+                if(valueBegin == std::string::npos || line[valueBegin] != '[')
+                {
+                    continue;
+                }
+                line.erase(0, valueBegin);
+            }
+            std::replace_if(line.begin(),
+                            line.end(),
+                            [](const char c) { return c == ',' || c == '[' || c == ']' || c == ';'; },
+                            ' ');
+
+            std::istringstream tokens(line);
+            std::vector<double> lineElements;
+            std::string token;
+            bool numeric = true;
+            while(numeric && tokens >> token)
+            {
+                std::istringstream tokenStream(token);
+                double element{ 0 };
+                numeric = (tokenStream >> element) && tokenStream.eof();
+                lineElements.emplace_back(element);
+            }
+            if(numeric)
+            {
+                elements.insert(elements.end(), lineElements.begin(), lineElements.end());
+            }
+        }
+
+        if(elements.size() > 16)
+        {
+            throw std::runtime_error("Robot pose has more than 16 values");
+        }
+        if(!elements.empty() && elements.size() != 16)
+        {
+            throw std::runtime_error("Incomplete robot pose at end of input (" + std::to_string(elements.size())
+                                     + " of 16 values)");
+        }
+        return elements.size() == 16;
+    }
+
+    /* 函数意义: 打印批量标定中每个位姿的耗时及总吞吐量;
+     */
+    void printPoseTimings(const std::vector<PoseTiming> &timings,
+                          const std::vector<HighResClock::duration> &inputDurations,
+                          const HighResClock::duration &totalDuration)
+    {
+        std::cout << std::left << std::fixed << std::setprecision(1) << std::setw(8) << "Pose" << std::setw(14)
+                  << "Input (ms)" << std::setw(14) << "Queue (ms)" << std::setw(14) << "Capture (ms)" << std::setw(16)
+                  << "Detection (ms)"
+                  << "Result" << std::endl;
+        for(const auto &timing : timings)
+        {
+            std::cout << std::setw(8) << timing.poseId << std::setw(14)
+                      << toMilliseconds(inputDurations.at(timing.poseId)) << std::setw(14)
+                      << toMilliseconds(timing.queueDuration) << std::setw(14)
+                      << toMilliseconds(timing.captureDuration) << std::setw(16)
+                      << toMilliseconds(timing.detectionDuration) << (timing.detected ? "OK" : "FAILED") << std::endl;
+        }
+
+        const auto totalSeconds = toMilliseconds(totalDuration) / 1000.0;
+        std::cout << timings.size() << " poses in " << totalSeconds << " s ("
+                  << (totalSeconds > 0.0 ? 60.0 * timings.size() / totalSeconds : 0.0) << " poses/min)" << std::endl;
+    }
+
+    /* 函数意义: 非交互式地从文件或管道读取所有机器人位姿, 并依次触发拍摄;
+     *      - 从管道读取时, 每个位姿在到达时立即拍摄, 机器人脚本应在机器人到位后再写入位姿;
+     *      - 每次拍摄完成后立即读取下一个位姿, 特征点检测在后台进行;
+     * 参数意义：
+     *      - [in]camera: 已连接的相机;
+     *      - [in]poses: 位姿输入流, 格式见readPoseElements;
+     *      - [in]datasetDirectory: 保存每一帧及其位姿的目录; 为空时不保存;
+     * 返回值：检测成功的标定输入, 按位姿顺序排列；
+     */
+    std::vector<Zivid::HandEye::CalibrationInput> collectCalibrationInputFromBatch(Zivid::Camera &camera,
+                                                                                   std::istream &poses,
+                                                                                   const std::string &datasetDirectory)
+    {
+        CalibrationPipeline pipeline(camera, datasetDirectory);
+        std::vector<HighResClock::duration> inputDurations;
+        std::vector<double> transformElements;
+
+        const auto beforeBatch = HighResClock::now();
+        auto beforeInput = beforeBatch;
+        // 拍摄失败的位姿也占用一个编号, 使编号与输入中的位姿顺序一致
+        for(size_t poseId = 0; readPoseElements(poses, transformElements); poseId++)
+        {
+            const auto afterInput = HighResClock::now();
+            inputDurations.push_back(afterInput - beforeInput);
+            const Zivid::Matrix4d robotPose{ transformElements.cbegin(), transformElements.cend() };
+
+            // 等待图像采集完成后再读取下一个位姿
+            try
+            {
+                pipeline.submit(poseId, robotPose).get();
+            }
+            catch(const std::exception &e)
+            {
+                std::cout << "Pose " << poseId << ": Error: " << Zivid::toString(e) << std::endl;
+                // 数据集中保留该位姿, 使离线检测中的编号与本次一致; 缺少的帧在离线检测时报告为错误
+                if(!datasetDirectory.empty())
+                {
+                    saveRobotPose(robotPose, datasetFilePath(datasetDirectory, "pose", poseId, ".txt"));
+                }
+            }
+            beforeInput = HighResClock::now();
+        }
+
+        std::cout << "Waiting for checkerboard detection to complete... " << std::endl;
+        const auto input = pipeline.finish();
+        printPoseTimings(pipeline.timings(), inputDurations, HighResClock::now() - beforeBatch);
+        return input;
+    }
+
+    /* 函数意义: 离线加载record模式保存的数据集, 并在所有CPU核心上并行检测棋盘格特征点; 不需要相机;
+     * 参数意义：
+     *      - [in]datasetDirectory: 数据集目录 (frame_00.zdf, pose_00.txt, frame_01.zdf, ...);
+     * 返回值：检测成功的位姿, 按位姿顺序排列；
+     */
+    std::vector<DetectedPose> detectDataset(const std::string &datasetDirectory)
+    {
+        size_t numPoses = 0;
+        while(fileExists(datasetFilePath(datasetDirectory, "pose", numPoses, ".txt")))
+        {
+            numPoses++;
+        }
+        if(numPoses == 0)
+        {
+            throw std::runtime_error("No recorded poses (pose_00.txt, ...) found in " + datasetDirectory);
+        }
+
+        std::vector<std::unique_ptr<Zivid::HandEye::CalibrationInput>> detectedInputs(numPoses);
+        std::vector<std::string> errors(numPoses);
+        std::vector<HighResClock::duration> loadDurations(numPoses, HighResClock::duration::zero());
+        std::vector<HighResClock::duration> detectDurations(numPoses, HighResClock::duration::zero());
+        std::atomic<size_t> nextPoseId{ 0 };
+
+        const auto detectPoses = [&]() {
+            for(size_t poseId = nextPoseId++; poseId < numPoses; poseId = nextPoseId++)
+            {
+                try
+                {
+                    const auto beforeLoad = HighResClock::now();
+                    const auto robotPose = loadRobotPose(datasetFilePath(datasetDirectory, "pose", poseId, ".txt"));
+                    const Zivid::Frame frame(datasetFilePath(datasetDirectory, "frame", poseId, ".zdf"));
+                    const auto pointCloud = frame.getPointCloud();
+                    const auto afterLoad = HighResClock::now();
+                    const auto result = Zivid::HandEye::detectFeaturePoints(pointCloud);
+                    const auto afterDetect = HighResClock::now();
+
+                    loadDurations.at(poseId) = afterLoad - beforeLoad;
+                    detectDurations.at(poseId) = afterDetect - afterLoad;
+                    if(result)
+                    {
+                        detectedInputs.at(poseId).reset(
+                            new Zivid::HandEye::CalibrationInput{ Zivid::HandEye::Pose{ robotPose }, result });
+                    }
+                    else
+                    {
+                        errors.at(poseId) = "checkerboard detection FAILED";
+                    }
+                }
+                catch(const std::exception &e)
+                {
+                    errors.at(poseId) = "Error: " + Zivid::toString(e);
+                }
+            }
+        };
+
+        const size_t numThreads =
+            std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), numPoses));
+        std::cout << "Loading and detecting " << numPoses << " poses from " << datasetDirectory << " on "
+                  << numThreads << " threads... " << std::endl;
+
+        const auto beforeDetection = HighResClock::now();
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < numThreads; i++)
+        {
+            threads.emplace_back(detectPoses);
+        }
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+        const auto afterDetection = HighResClock::now();
+
+        std::vector<DetectedPose> detectedPoses;
+        for(size_t poseId = 0; poseId < numPoses; poseId++)
+        {
+            if(detectedInputs.at(poseId))
+            {
+                std::cout << "Pose " << poseId << ": checkerboard square centers detected" << std::endl;
+                detectedPoses.emplace_back(DetectedPose{ poseId, *detectedInputs.at(poseId) });
+            }
+            else
+            {
+                std::cout << "Pose " << poseId << ": " << errors.at(poseId) << std::endl;
+            }
+        }
+
+        const auto totalLoadDuration =
+            std::accumulate(loadDurations.begin(), loadDurations.end(), HighResClock::duration::zero());
+        const auto totalDetectDuration =
+            std::accumulate(detectDurations.begin(), detectDurations.end(), HighResClock::duration::zero());
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Load ZDF and pose: " << toMilliseconds(totalLoadDuration) << " ms (sum over poses)\n"
+                  << "Detect feature points: " << toMilliseconds(totalDetectDuration) << " ms (sum over poses)\n"
+                  << "Load and detect: " << toMilliseconds(afterDetection - beforeDetection) << " ms (wall time)"
+                  << std::endl;
+
+        return detectedPoses;
+    }
+
+    std::vector<Zivid::HandEye::CalibrationInput> toCalibrationInput(const std::vector<DetectedPose> &detectedPoses)
+    {
+        std::vector<Zivid::HandEye::CalibrationInput> input;
+        for(const auto &detectedPose : detectedPoses)
+        {
+            input.emplace_back(detectedPose.input);
+        }
+        return input;
+    }
+
+    /* 函数意义: 标定质量评分; 对子集执行手眼标定, 返回平均残差 (平移残差 + 旋转残差的加权和), 越小越好;
+     *      - 旋转残差按每度10mm折算, 约相当于工作距离600mm处的位置误差;
+     *      - 残差只在子集内的位姿上计算, 因此只有大小相同的子集之间的评分可以直接比较;
+     * 参数意义：
+     *      - [in]detectedPoses: 所有检测成功的位姿;
+     *      - [in]subset: 子集中位姿在detectedPoses中的下标;
+     * 返回值：评分; 标定失败时为无穷大；
+     */
+    double calibrationScore(const std::vector<DetectedPose> &detectedPoses, const std::vector<size_t> &subset)
+    {
+        const double rotationWeightMillimetersPerDegree = 10.0;
+
+        std::vector<Zivid::HandEye::CalibrationInput> input;
+        input.reserve(subset.size());
+        for(const auto index : subset)
+        {
+            input.emplace_back(detectedPoses.at(index).input);
+        }
+
+        const auto calibrationResult = Zivid::HandEye::calibrateEyeToHand(input);
+        const auto residuals = calibrationResult ? calibrationResult.residuals()
+                                                 : std::vector<Zivid::HandEye::CalibrationResidual>{};
+        if(residuals.empty())
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        double score = 0.0;
+        for(const auto &residual : residuals)
+        {
+            score += residual.translation() + rotationWeightMillimetersPerDegree * residual.rotation();
+        }
+        return score / residuals.size();
+    }
+
+    /* 函数意义: 在所有CPU核心上并行计算每个子集的标定评分;
+     */
+    std::vector<double> scoreSubsets(const std::vector<DetectedPose> &detectedPoses,
+                                     const std::vector<std::vector<size_t>> &subsets)
+    {
+        std::vector<double> scores(subsets.size(), std::numeric_limits<double>::infinity());
+        std::atomic<size_t> nextSubset{ 0 };
+
+        const auto scoreNextSubsets = [&]() {
+            for(size_t i = nextSubset++; i < subsets.size(); i = nextSubset++)
+            {
+                try
+                {
+                    scores.at(i) = calibrationScore(detectedPoses, subsets.at(i));
+                }
+                catch(const std::exception &)
+                {
+                    // 标定失败的子集保持无穷大的评分
+                }
+            }
+        };
+
+        const size_t numThreads =
+            std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), subsets.size()));
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < numThreads; i++)
+        {
+            threads.emplace_back(scoreNextSubsets);
+        }
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+        return scores;
+    }
+
+    /* 函数意义: 寻找剔除坏位姿后的最佳位姿子集;
+     *      - 并行执行留一法 (leave-one-out) 标定, 按剔除每个位姿后评分的改善程度对位姿排序;
+     *      - 再并行评估随机子集以及按排序剔除最差位姿的子集, 每个子集都剔除numRejected个位姿;
+     * 参数意义：
+     *      - [in]detectedPoses: 所有检测成功的位姿;
+     *      - [in]numRejected: 每个候选子集剔除的位姿数量;
+     *      - [in]numRandomSubsets: 随机子集的数量;
+     *      - [in]seed: 随机数种子;
+     * 返回值：评分最好的子集中的位姿, 按位姿顺序排列；
+     */
+    std::vector<DetectedPose> selectBestPoseSubset(const std::vector<DetectedPose> &detectedPoses,
+                                                   const size_t numRejected,
+                                                   const size_t numRandomSubsets,
+                                                   const unsigned int seed)
+    {
+        const size_t numPoses = detectedPoses.size();
+        if(numRejected == 0 || numPoses < numRejected + 3)
+        {
+            throw std::invalid_argument("Cannot reject " + std::to_string(numRejected) + " of "
+                                        + std::to_string(numPoses) + " poses");
+        }
+
+        const auto beforeSearch = HighResClock::now();
+
+        std::vector<size_t> allPoses(numPoses);
+        std::iota(allPoses.begin(), allPoses.end(), 0);
+
+        // 基准 (所有位姿) 和留一法子集
+        std::vector<std::vector<size_t>> leaveOneOutSubsets{ allPoses };
+        for(size_t excluded = 0; excluded < numPoses; excluded++)
+        {
+            std::vector<size_t> subset;
+            std::copy_if(allPoses.begin(), allPoses.end(), std::back_inserter(subset), [excluded](const size_t index) {
+                return index != excluded;
+            });
+            leaveOneOutSubsets.push_back(subset);
+        }
+        const auto leaveOneOutScores = scoreSubsets(detectedPoses, leaveOneOutSubsets);
+        const auto baselineScore = leaveOneOutScores.at(0);
+
+        // 按剔除后评分的改善程度排序, 改善最大的位姿最可疑
+        std::vector<size_t> ranking(allPoses);
+        std::sort(ranking.begin(), ranking.end(), [&leaveOneOutScores](const size_t a, const size_t b) {
+            return leaveOneOutScores.at(a + 1) < leaveOneOutScores.at(b + 1);
+        });
+
+        std::cout << std::fixed << std::setprecision(3) << "Baseline score (all " << numPoses
+                  << " poses): " << baselineScore << std::endl;
+        std::cout << std::left << std::setw(8) << "Rank" << std::setw(8) << "Pose" << std::setw(22)
+                  << "Score without pose"
+                  << "Improvement" << std::endl;
+        for(size_t rank = 0; rank < ranking.size(); rank++)
+        {
+            const auto index = ranking.at(rank);
+            const auto score = leaveOneOutScores.at(index + 1);
+            std::cout << std::setw(8) << rank + 1 << std::setw(8) << detectedPoses.at(index).poseId << std::setw(22)
+                      << score << baselineScore - score << std::endl;
+        }
+
+        // 候选子集: 按排序剔除最差的位姿, 以及随机剔除的子集
+        std::vector<std::vector<size_t>> candidateSubsets;
+        std::vector<size_t> guidedSubset(ranking.begin() + numRejected, ranking.end());
+        std::sort(guidedSubset.begin(), guidedSubset.end());
+        candidateSubsets.push_back(guidedSubset);
+
+        std::mt19937 randomEngine(seed);
+        for(size_t i = 0; i < numRandomSubsets; i++)
+        {
+            auto subset = allPoses;
+            std::shuffle(subset.begin(), subset.end(), randomEngine);
+            subset.resize(numPoses - numRejected);
+            std::sort(subset.begin(), subset.end());
+            candidateSubsets.push_back(subset);
+        }
+        const auto candidateScores = scoreSubsets(detectedPoses, candidateSubsets);
+        const auto bestCandidate = static_cast<size_t>(
+            std::distance(candidateScores.begin(), std::min_element(candidateScores.begin(), candidateScores.end())));
+
+        const auto afterSearch = HighResClock::now();
+
+        std::vector<DetectedPose> bestSubset;
+        std::string rejectedPoses;
+        for(const auto index : allPoses)
+        {
+            const auto &subset = candidateSubsets.at(bestCandidate);
+            if(std::binary_search(subset.begin(), subset.end(), index))
+            {
+                bestSubset.push_back(detectedPoses.at(index));
+            }
+            else
+            {
+                rejectedPoses += " " + std::to_string(detectedPoses.at(index).poseId);
+            }
+        }
+
+        std::cout << "Best subset of " << bestSubset.size() << " poses ("
+                  << (bestCandidate == 0 ? "leave-one-out ranking" : "random subset") << "), score "
+                  << candidateScores.at(bestCandidate) << ", rejected poses:" << rejectedPoses << std::endl;
+        std::cout << "Evaluated " << leaveOneOutSubsets.size() + candidateSubsets.size() << " calibrations in "
+                  << std::setprecision(1) << toMilliseconds(afterSearch - beforeSearch) << " ms" << std::endl;
+
+        return bestSubset;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        auto mode = Mode::interactive;
+        std::string datasetDirectory;
+        std::string posesFile;
+        auto posesOption = (clipp::option("--poses") & clipp::value("file", posesFile))
+                           % "read all robot poses from a CSV/YAML file, or from stdin if file is -";
+        auto recordMode =
+            (clipp::command("record").set(mode, Mode::record), clipp::value("dataset", datasetDirectory), posesOption);
+        auto offlineMode =
+            (clipp::command("offline").set(mode, Mode::offline), clipp::value("dataset", datasetDirectory));
+        size_t numRejected = 1;
+        size_t numRandomSubsets = 200;
+        unsigned int seed = 0;
+        auto selectMode = (clipp::command("select").set(mode, Mode::select),
+                           clipp::value("dataset", datasetDirectory),
+                           clipp::option("--reject") & clipp::value("count", numRejected),
+                           clipp::option("--random-subsets") & clipp::value("count", numRandomSubsets),
+                           clipp::option("--seed") & clipp::value("seed", seed));
+        auto cli = (recordMode | offlineMode | selectMode | posesOption);
+
+        if(argc > 1 && !parse(argc, argv, cli))
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        Zivid::Application zivid;
+
+        std::vector<Zivid::HandEye::CalibrationInput> input;
+        if(mode == Mode::offline)
+        {
+            input = toCalibrationInput(detectDataset(datasetDirectory));
+        }
+        else if(mode == Mode::select)
+        {
+            input = toCalibrationInput(
+                selectBestPoseSubset(detectDataset(datasetDirectory), numRejected, numRandomSubsets, seed));
+        }
+        else
+        {
+            // 连接相机
+            std::cout << "Connecting to camera..." << std::endl;
+            auto camera{ zivid.connectCamera() };
+
+            if(posesFile.empty())
+            {
+                input = collectCalibrationInput(camera, datasetDirectory);
+            }
+            else if(posesFile == "-")
+            {
+                input = collectCalibrationInputFromBatch(camera, std::cin, datasetDirectory);
+            }
+            else
+            {
+                std::ifstream poses(posesFile);
+                if(!poses)
+                {
+                    throw std::runtime_error("Could not open " + posesFile);
+                }
+                input = collectCalibrationInputFromBatch(camera, poses, datasetDirectory);
+            }
+        }
+
 		// 执行手眼标定
         std::cout << "Performing hand-eye calibration ... " << std::flush;
+        const auto beforeCalibration = HighResClock::now();
         const auto calibrationResult{ Zivid::HandEye::calibrateEyeToHand(input) };
+        const auto afterCalibration = HighResClock::now();
         if(calibrationResult)
         {
-            std::cout << "OK\n"
+            std::cout << "OK (" << std::fixed << std::setprecision(1)
+                      << toMilliseconds(afterCalibration - beforeCalibration) << " ms)\n"
                       << "Result:\n"
                       << calibrationResult << std::endl;
         }
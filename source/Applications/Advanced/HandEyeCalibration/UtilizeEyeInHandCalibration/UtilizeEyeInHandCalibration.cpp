@@ -1,42 +1,194 @@
 /*
 Utilize the result of eye-in-hand calibration to transform (picking) point
 coordinates from the camera frame to the robot base frame.
+
+The same camera-to-base transform is also applied to every point of a Zivid
+point cloud, using all available cores.
+
+Run with "serve" to keep the hand-eye transform loaded in a resident process
+that transforms streamed points received over a Unix domain socket, or with
+"benchmark" to measure the round-trip latency and throughput of that service
+with a local client.
 */
 
+#include <Zivid/Zivid.h>
+
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 #include <opencv2/core/core.hpp>
 
+#include <ParallelRanges.h>
+
+#include <clipp.h>
+
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define PICKING_POINT_SERVICE_SUPPORTED
+#    include <cerrno>
+#    include <csignal>
+#    include <cstring>
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+enum class Mode
+{
+    demo,
+    serve,
+    benchmark
+};
+
+enum class Precision
+{
+    singleFloat,
+    doubleAccumulate
+};
+
+/*
+Wire format of the picking point service. Every message starts with a header. A setBaseToEndEffector message is
+followed by 16 doubles (row-major 4x4 end-effector pose in the robot base frame) and has no reply. A transformPoints
+message is followed by numPoints x, y, z triplets (doubles) in the camera frame, and is answered with a header and
+the same number of triplets in the robot base frame. Both ends run on the same host, so native byte order is used.
+*/
+enum class ServiceCommand : uint32_t
+{
+    setBaseToEndEffector = 1,
+    transformPoints = 2
+};
 
-Eigen::MatrixXd cvToEigen(const cv::Mat &);
+struct ServiceMessageHeader
+{
+    uint32_t command;
+    uint32_t numPoints;
+};
+
+// Largest batch of points that the service accepts in one transformPoints message
+const uint32_t maxPointsPerBatch = 1U << 22U;
+
+/*
+Camera pose in the robot base frame, composed from the eye-in-hand calibration result and the current
+end-effector pose. The composition is computed once and reused until one of the input poses changes.
+*/
+class HandEyeTransformChain
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    HandEyeTransformChain(const Eigen::Affine3d &endEffectorToCamera, const Eigen::Affine3d &baseToEndEffector);
+
+    void setEndEffectorToCamera(const Eigen::Affine3d &endEffectorToCamera);
+    void setBaseToEndEffector(const Eigen::Affine3d &baseToEndEffector);
+
+    const Eigen::Affine3d &baseToCamera();
+    Eigen::Vector3d transformPoint(const Eigen::Vector3d &pointInCameraFrame);
+    void transformPoints(const Eigen::Ref<const Eigen::Matrix3Xd> &pointsInCameraFrame,
+                         Eigen::Ref<Eigen::Matrix3Xd> pointsInBaseFrame);
+
+private:
+    Eigen::Affine3d m_endEffectorToCamera;
+    Eigen::Affine3d m_baseToEndEffector;
+    Eigen::Affine3d m_baseToCamera;
+    bool m_baseToCameraIsStale;
+};
+
+Eigen::Matrix4d cvToEigen(const cv::Mat &);
 cv::Mat readTransform(const std::string &);
+void transformPointCloud(const Eigen::Matrix4d &, Zivid::PointCloud &, Precision);
+void transformPointCloud(const Eigen::Matrix4d &, const Zivid::PointCloud &, Zivid::PointCloud &, Precision);
+void transformPoints(const Eigen::Matrix4d &, const Zivid::Point *, Zivid::Point *, size_t, Precision);
+template<typename Scalar>
+void transformPointRange(const Eigen::Matrix4d &, const Zivid::Point *, Zivid::Point *, size_t);
+void printPoint(const std::string &, const Zivid::Point &);
+void runDemo(HandEyeTransformChain &, const Eigen::Affine3d &);
+#ifdef PICKING_POINT_SERVICE_SUPPORTED
+int listenOnSocket(const std::string &);
+int connectToSocket(const std::string &);
+bool readAll(int, void *, size_t);
+bool writeAll(int, const void *, size_t);
+void handleServiceConnection(int, std::unique_ptr<HandEyeTransformChain>);
+void runPickingPointService(const std::string &, const Eigen::Affine3d &, const Eigen::Affine3d &);
+void benchmarkPickingPointService(const std::string &,
+                                  const Eigen::Affine3d &,
+                                  const Eigen::Affine3d &,
+                                  const std::vector<size_t> &,
+                                  size_t);
+#endif
 
-int main()
+int main(int argc, char **argv)
 {
     try
     {
-        // define (picking) point in camera frame
-        const Eigen::Vector4d pointInCameraFrame(81.2, 18.0, 594.6, 1);
-        std::cout << "Point coordinates in camera frame: " << pointInCameraFrame.segment(0, 3).transpose() << std::endl;
+        auto mode = Mode::demo;
+        std::string socketPath = "PickingPointService.sock";
+        std::vector<size_t> batchSizes{ 1, 16, 256, 4096 };
+        size_t numRoundTrips = 1000;
 
-        // Read camera pose in end-effector frame (result of eye-in-hand calibration)
-        const auto eyeInHandTransformation = readTransform("handEyeTransform.yaml");
+        auto serveMode = (clipp::command("serve").set(mode, Mode::serve),
+                          clipp::option("--socket") & clipp::value("path", socketPath));
+        auto benchmarkMode = (clipp::command("benchmark").set(mode, Mode::benchmark),
+                              clipp::option("--socket") & clipp::value("path", socketPath),
+                              clipp::option("--batch-sizes") & clipp::values("points", batchSizes),
+                              clipp::option("--round-trips") & clipp::value("count", numRoundTrips));
+        auto cli = (serveMode | benchmarkMode);
 
-        // Read end-effector pose in robot base frame
-        const auto endEffectorPose = readTransform("robotTransform.yaml");
+        if(argc > 1 && !parse(argc, argv, cli))
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(mode == Mode::benchmark)
+        {
+            if(numRoundTrips == 0) throw std::invalid_argument("--round-trips must be at least 1");
+            for(const auto batchSize : batchSizes)
+            {
+                if(batchSize == 0 || batchSize > maxPointsPerBatch)
+                {
+                    throw std::invalid_argument("--batch-sizes must be between 1 and "
+                                                + std::to_string(maxPointsPerBatch) + " points");
+                }
+            }
+        }
 
-        // convert to Eigen matrices for easier computation
-        const auto transformEndEffectorToCamera = cvToEigen(eyeInHandTransformation);
-        const auto transformBaseToEndEffector = cvToEigen(endEffectorPose);
+        // Read camera pose in end-effector frame (result of eye-in-hand calibration)
+        const Eigen::Affine3d transformEndEffectorToCamera(cvToEigen(readTransform("handEyeTransform.yaml")));
 
-        // Compute camera pose in robot base frame
-        const auto transform_base_to_camera = transformBaseToEndEffector * transformEndEffectorToCamera;
+        // Read end-effector pose in robot base frame
+        const Eigen::Affine3d transformBaseToEndEffector(cvToEigen(readTransform("robotTransform.yaml")));
 
-        // compute (picking) point in robot base frame
-        const auto pointInBaseFrame = transform_base_to_camera * pointInCameraFrame;
-        std::cout << "Point coordinates in robot base frame: " << pointInBaseFrame.segment(0, 3).transpose()
-                  << std::endl;
+        switch(mode)
+        {
+            case Mode::demo:
+            {
+                // Compute camera pose in robot base frame, cached until one of the poses changes
+                HandEyeTransformChain transformChain(transformEndEffectorToCamera, transformBaseToEndEffector);
+                runDemo(transformChain, transformBaseToEndEffector);
+                break;
+            }
+#ifdef PICKING_POINT_SERVICE_SUPPORTED
+            case Mode::serve:
+                runPickingPointService(socketPath, transformEndEffectorToCamera, transformBaseToEndEffector);
+                break;
+            case Mode::benchmark:
+                benchmarkPickingPointService(
+                    socketPath, transformEndEffectorToCamera, transformBaseToEndEffector, batchSizes, numRoundTrips);
+                break;
+#else
+            case Mode::serve:
+            case Mode::benchmark:
+                throw std::runtime_error("The picking point service requires Unix domain sockets");
+#endif
+        }
     }
 
     catch(const std::exception &e)
@@ -46,21 +198,86 @@ int main()
     }
 }
 
-Eigen::MatrixXd cvToEigen(const cv::Mat &cvMat)
+HandEyeTransformChain::HandEyeTransformChain(const Eigen::Affine3d &endEffectorToCamera,
+                                             const Eigen::Affine3d &baseToEndEffector)
+    : m_endEffectorToCamera(endEffectorToCamera)
+    , m_baseToEndEffector(baseToEndEffector)
+    , m_baseToCamera(Eigen::Affine3d::Identity())
+    , m_baseToCameraIsStale(true)
+{}
+
+void HandEyeTransformChain::setEndEffectorToCamera(const Eigen::Affine3d &endEffectorToCamera)
+{
+    if(endEffectorToCamera.matrix() != m_endEffectorToCamera.matrix())
+    {
+        m_endEffectorToCamera = endEffectorToCamera;
+        m_baseToCameraIsStale = true;
+    }
+}
+
+void HandEyeTransformChain::setBaseToEndEffector(const Eigen::Affine3d &baseToEndEffector)
+{
+    if(baseToEndEffector.matrix() != m_baseToEndEffector.matrix())
+    {
+        m_baseToEndEffector = baseToEndEffector;
+        m_baseToCameraIsStale = true;
+    }
+}
+
+const Eigen::Affine3d &HandEyeTransformChain::baseToCamera()
+{
+    if(m_baseToCameraIsStale)
+    {
+        m_baseToCamera = m_baseToEndEffector * m_endEffectorToCamera;
+        m_baseToCameraIsStale = false;
+    }
+    return m_baseToCamera;
+}
+
+Eigen::Vector3d HandEyeTransformChain::transformPoint(const Eigen::Vector3d &pointInCameraFrame)
+{
+    return baseToCamera() * pointInCameraFrame;
+}
+
+void HandEyeTransformChain::transformPoints(const Eigen::Ref<const Eigen::Matrix3Xd> &pointsInCameraFrame,
+                                            Eigen::Ref<Eigen::Matrix3Xd> pointsInBaseFrame)
+{
+    /*
+	Writes into caller-owned storage. The 3x3 times 3xN product is evaluated coefficient-wise by Eigen,
+	so no temporaries are allocated. Build with EIGEN_RUNTIME_NO_MALLOC defined (and without NDEBUG) to have
+	Eigen assert on any heap allocation made by the product.
+	*/
+
+    if(pointsInCameraFrame.cols() != pointsInBaseFrame.cols())
+    {
+        throw std::invalid_argument("Expected " + std::to_string(pointsInCameraFrame.cols())
+                                    + " columns in output matrix, but got " + std::to_string(pointsInBaseFrame.cols()));
+    }
+
+    const auto &transform = baseToCamera();
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+    Eigen::internal::set_is_malloc_allowed(false);
+#endif
+    pointsInBaseFrame.noalias() = transform.linear() * pointsInCameraFrame;
+    pointsInBaseFrame.colwise() += transform.translation();
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+    Eigen::internal::set_is_malloc_allowed(true);
+#endif
+}
+
+Eigen::Matrix4d cvToEigen(const cv::Mat &cvMat)
 {
-    if(cvMat.dims > 2)
+    if(cvMat.dims > 2 || cvMat.rows != 4 || cvMat.cols != 4 || cvMat.type() != CV_64F)
     {
-        throw std::invalid_argument("Invalid matrix dimensions. Expected 2D.");
+        throw std::invalid_argument("Invalid matrix. Expected 4x4 matrix of doubles.");
     }
 
-    Eigen::MatrixXd eigenMat(cvMat.rows, cvMat.cols);
+    Eigen::Matrix4d eigenMat;
 
+    // cv::Mat rows are contiguous even when the matrix as a whole is not
     for(int i = 0; i < cvMat.rows; i++)
     {
-        for(int j = 0; j < cvMat.cols; j++)
-        {
-            eigenMat(i, j) = cvMat.at<double>(i, j);
-        }
+        eigenMat.row(i) = Eigen::Map<const Eigen::RowVector4d>(cvMat.ptr<double>(i));
     }
 
     return eigenMat;
@@ -100,4 +317,473 @@ cv::Mat readTransform(const std::string &file_name)
         fileStorage.release();
         throw;
     }
-}
\ No newline at end of file
+}
+
+void transformPointCloud(const Eigen::Matrix4d &transform, Zivid::PointCloud &pointCloud, const Precision precision)
+{
+    transformPoints(transform, pointCloud.dataPtr(), pointCloud.dataPtr(), pointCloud.size(), precision);
+}
+
+void transformPointCloud(const Eigen::Matrix4d &transform,
+                         const Zivid::PointCloud &source,
+                         Zivid::PointCloud &destination,
+                         const Precision precision)
+{
+    if(source.width() != destination.width() || source.height() != destination.height())
+    {
+        throw std::invalid_argument("Destination point cloud (" + std::to_string(destination.width()) + "x"
+                                    + std::to_string(destination.height()) + ") does not match source point cloud ("
+                                    + std::to_string(source.width()) + "x" + std::to_string(source.height()) + ")");
+    }
+
+    transformPoints(transform, source.dataPtr(), destination.dataPtr(), source.size(), precision);
+}
+
+void transformPoints(const Eigen::Matrix4d &transform,
+                     const Zivid::Point *source,
+                     Zivid::Point *destination,
+                     const size_t numPoints,
+                     const Precision precision)
+{
+    /*
+	Splits the points into one contiguous range per hardware thread. Source and destination may be the same
+	buffer. NaN coordinates (missing points) stay NaN, since any arithmetic involving NaN yields NaN.
+	*/
+
+    const auto transformRange =
+        [&transform, source, destination, precision](size_t, const size_t begin, const size_t end) {
+            if(precision == Precision::singleFloat)
+            {
+                transformPointRange<float>(transform, source + begin, destination + begin, end - begin);
+            }
+            else
+            {
+                transformPointRange<double>(transform, source + begin, destination + begin, end - begin);
+            }
+        };
+    Utils::forEachRange(numPoints, Utils::computeNumRanges(numPoints), transformRange);
+}
+
+template<typename Scalar>
+void transformPointRange(const Eigen::Matrix4d &transform,
+                         const Zivid::Point *source,
+                         Zivid::Point *destination,
+                         const size_t numPoints)
+{
+    /*
+	The points are deinterleaved block by block into local coordinate arrays, so that the multiply-add loop
+	runs over contiguous memory and is vectorized by the compiler. Scalar selects the precision of the
+	arithmetic; the result is always stored as float.
+	*/
+
+    constexpr size_t blockSize = 256;
+
+    Scalar m[3][4];
+    for(size_t row = 0; row < 3; row++)
+    {
+        for(size_t col = 0; col < 4; col++)
+        {
+            m[row][col] = static_cast<Scalar>(transform(row, col));
+        }
+    }
+
+    alignas(32) Scalar x[blockSize];
+    alignas(32) Scalar y[blockSize];
+    alignas(32) Scalar z[blockSize];
+
+    for(size_t blockStart = 0; blockStart < numPoints; blockStart += blockSize)
+    {
+        const size_t count = std::min(blockSize, numPoints - blockStart);
+        const Zivid::Point *in = source + blockStart;
+        Zivid::Point *out = destination + blockStart;
+
+        for(size_t k = 0; k < count; k++)
+        {
+            x[k] = in[k].x;
+            y[k] = in[k].y;
+            z[k] = in[k].z;
+        }
+
+        for(size_t k = 0; k < count; k++)
+        {
+            const Scalar px = x[k];
+            const Scalar py = y[k];
+            const Scalar pz = z[k];
+            x[k] = m[0][0] * px + m[0][1] * py + m[0][2] * pz + m[0][3];
+            y[k] = m[1][0] * px + m[1][1] * py + m[1][2] * pz + m[1][3];
+            z[k] = m[2][0] * px + m[2][1] * py + m[2][2] * pz + m[2][3];
+        }
+
+        if(in != out)
+        {
+            std::copy(in, in + count, out);
+        }
+
+        for(size_t k = 0; k < count; k++)
+        {
+            out[k].x = static_cast<float>(x[k]);
+            out[k].y = static_cast<float>(y[k]);
+            out[k].z = static_cast<float>(z[k]);
+        }
+    }
+}
+
+void printPoint(const std::string &label, const Zivid::Point &point)
+{
+    std::cout << label << " " << point.x << " " << point.y << " " << point.z << std::endl;
+}
+
+void runDemo(HandEyeTransformChain &transformChain, const Eigen::Affine3d &transformBaseToEndEffector)
+{
+    Zivid::Application zivid;
+
+    // define (picking) point in camera frame
+    const Eigen::Vector3d pointInCameraFrame(81.2, 18.0, 594.6);
+    std::cout << "Point coordinates in camera frame: " << pointInCameraFrame.transpose() << std::endl;
+
+    // compute (picking) point in robot base frame
+    const auto pointInBaseFrame = transformChain.transformPoint(pointInCameraFrame);
+    std::cout << "Point coordinates in robot base frame: " << pointInBaseFrame.transpose() << std::endl;
+
+    // Transform a batch of picking candidates into preallocated storage
+    const Eigen::Index numPickingCandidates = 10000;
+    const Eigen::Matrix3Xd pickingCandidatesInCameraFrame =
+        pointInCameraFrame.replicate(1, numPickingCandidates) + Eigen::Matrix3Xd::Random(3, numPickingCandidates);
+    Eigen::Matrix3Xd pickingCandidatesInBaseFrame(3, numPickingCandidates);
+
+    // Setting an unchanged pose does not invalidate the cached transform
+    transformChain.setBaseToEndEffector(transformBaseToEndEffector);
+    const auto beforeBatchTransform = std::chrono::high_resolution_clock::now();
+    transformChain.transformPoints(pickingCandidatesInCameraFrame, pickingCandidatesInBaseFrame);
+    const auto afterBatchTransform = std::chrono::high_resolution_clock::now();
+    using Microseconds = std::chrono::duration<double, std::micro>;
+    std::cout << "Transformed " << numPickingCandidates << " picking candidates in "
+              << std::chrono::duration_cast<Microseconds>(afterBatchTransform - beforeBatchTransform).count() << " us"
+              << std::endl;
+
+    const Eigen::Matrix4d transform_base_to_camera = transformChain.baseToCamera().matrix();
+
+    const std::string filename = "Zivid3D.zdf";
+    std::cout << "Reading " << filename << " point cloud" << std::endl;
+    const Zivid::Frame frame = Zivid::Frame(filename);
+    auto pointCloud = frame.getPointCloud();
+    const auto centerIndex = (pointCloud.height() / 2) * pointCloud.width() + pointCloud.width() / 2;
+    printPoint("Center point in camera frame:", pointCloud(centerIndex));
+
+    // Transform into a preallocated point cloud, leaving the source untouched
+    Zivid::PointCloud pointCloudInBaseFrame(pointCloud.height(), pointCloud.width());
+    const auto beforeFloatTransform = std::chrono::high_resolution_clock::now();
+    transformPointCloud(transform_base_to_camera, pointCloud, pointCloudInBaseFrame, Precision::singleFloat);
+    const auto afterFloatTransform = std::chrono::high_resolution_clock::now();
+    printPoint("Center point in robot base frame (float):", pointCloudInBaseFrame(centerIndex));
+
+    // Transform in place, accumulating in double precision
+    transformPointCloud(transform_base_to_camera, pointCloud, Precision::doubleAccumulate);
+    const auto afterDoubleTransform = std::chrono::high_resolution_clock::now();
+    printPoint("Center point in robot base frame (double accumulate):", pointCloud(centerIndex));
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    std::cout << "Transformed " << pointCloud.size() << " points in "
+              << std::chrono::duration_cast<Milliseconds>(afterFloatTransform - beforeFloatTransform).count()
+              << " ms (float) and "
+              << std::chrono::duration_cast<Milliseconds>(afterDoubleTransform - afterFloatTransform).count()
+              << " ms (double accumulate)" << std::endl;
+}
+
+#ifdef PICKING_POINT_SERVICE_SUPPORTED
+int listenOnSocket(const std::string &socketPath)
+{
+    sockaddr_un address{};
+    if(socketPath.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Socket path is too long: " + socketPath);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0)
+    {
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    }
+
+    // Remove a stale socket file left behind by a previous run
+    unlink(socketPath.c_str());
+
+    if(bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0)
+    {
+        const std::string error = std::strerror(errno);
+        close(listener);
+        throw std::runtime_error("Could not listen on " + socketPath + ": " + error);
+    }
+
+    return listener;
+}
+
+int connectToSocket(const std::string &socketPath)
+{
+    sockaddr_un address{};
+    if(socketPath.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Socket path is too long: " + socketPath);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(connection < 0)
+    {
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    }
+
+    if(connect(connection, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        const std::string error = std::strerror(errno);
+        close(connection);
+        throw std::runtime_error("Could not connect to " + socketPath + ": " + error);
+    }
+
+    return connection;
+}
+
+bool readAll(const int fileDescriptor, void *buffer, const size_t numBytes)
+{
+    auto *bytes = static_cast<char *>(buffer);
+    size_t numBytesRead = 0;
+    while(numBytesRead < numBytes)
+    {
+        const auto result = read(fileDescriptor, bytes + numBytesRead, numBytes - numBytesRead);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            return false;
+        }
+        numBytesRead += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+bool writeAll(const int fileDescriptor, const void *buffer, const size_t numBytes)
+{
+    const auto *bytes = static_cast<const char *>(buffer);
+    size_t numBytesWritten = 0;
+    while(numBytesWritten < numBytes)
+    {
+        const auto result = write(fileDescriptor, bytes + numBytesWritten, numBytes - numBytesWritten);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            return false;
+        }
+        numBytesWritten += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+void handleServiceConnection(const int connection, std::unique_ptr<HandEyeTransformChain> transformChain)
+{
+    /*
+	Serves one client until it disconnects. Each client has its own end-effector pose. The point buffers only
+	grow, so a client streaming batches of similar size causes no allocations after the first batch. This runs
+	on a detached thread, so an error only closes this connection instead of terminating the whole service.
+	*/
+
+    std::vector<double> pointsInCameraFrame;
+    std::vector<double> pointsInBaseFrame;
+    ServiceMessageHeader header{};
+
+    try
+    {
+        while(readAll(connection, &header, sizeof(header)))
+        {
+            if(header.command == static_cast<uint32_t>(ServiceCommand::setBaseToEndEffector))
+            {
+                Eigen::Matrix<double, 4, 4, Eigen::RowMajor> baseToEndEffector;
+                if(!readAll(connection, baseToEndEffector.data(), sizeof(double) * baseToEndEffector.size()))
+                {
+                    break;
+                }
+                transformChain->setBaseToEndEffector(Eigen::Affine3d(Eigen::Matrix4d(baseToEndEffector)));
+            }
+            else if(header.command == static_cast<uint32_t>(ServiceCommand::transformPoints)
+                    && header.numPoints <= maxPointsPerBatch)
+            {
+                const size_t numValues = 3 * static_cast<size_t>(header.numPoints);
+                pointsInCameraFrame.resize(numValues);
+                pointsInBaseFrame.resize(numValues);
+                if(!readAll(connection, pointsInCameraFrame.data(), sizeof(double) * numValues))
+                {
+                    break;
+                }
+
+                transformChain->transformPoints(
+                    Eigen::Map<const Eigen::Matrix3Xd>(pointsInCameraFrame.data(), 3, header.numPoints),
+                    Eigen::Map<Eigen::Matrix3Xd>(pointsInBaseFrame.data(), 3, header.numPoints));
+
+                if(!writeAll(connection, &header, sizeof(header))
+                   || !writeAll(connection, pointsInBaseFrame.data(), sizeof(double) * numValues))
+                {
+                    break;
+                }
+            }
+            else
+            {
+                std::cerr << "Invalid message (command " << header.command << ", " << header.numPoints
+                          << " points), closing connection" << std::endl;
+                break;
+            }
+        }
+    }
+    catch(const std::exception &e)
+    {
+        std::cerr << "Error while serving a client, closing connection: " << e.what() << std::endl;
+    }
+
+    close(connection);
+}
+
+void runPickingPointService(const std::string &socketPath,
+                            const Eigen::Affine3d &transformEndEffectorToCamera,
+                            const Eigen::Affine3d &transformBaseToEndEffector)
+{
+    // A client disconnecting mid-reply must not terminate the service
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int listener = listenOnSocket(socketPath);
+    std::cout << "Picking point service listening on " << socketPath << std::endl;
+
+    while(true)
+    {
+        const int connection = accept(listener, nullptr, nullptr);
+        if(connection < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            const std::string error = std::strerror(errno);
+            close(listener);
+            throw std::runtime_error("Could not accept connection: " + error);
+        }
+
+        std::unique_ptr<HandEyeTransformChain> transformChain(
+            new HandEyeTransformChain(transformEndEffectorToCamera, transformBaseToEndEffector));
+        std::thread(handleServiceConnection, connection, std::move(transformChain)).detach();
+    }
+}
+
+void benchmarkPickingPointService(const std::string &socketPath,
+                                  const Eigen::Affine3d &transformEndEffectorToCamera,
+                                  const Eigen::Affine3d &transformBaseToEndEffector,
+                                  const std::vector<size_t> &batchSizes,
+                                  const size_t numRoundTrips)
+{
+    /*
+	Runs the service on a background thread and measures full round-trips over the socket from a local client:
+	sending an end-effector pose and a batch of points, and receiving the transformed batch.
+	*/
+
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int listener = listenOnSocket(socketPath);
+    std::thread service([listener, &transformEndEffectorToCamera, &transformBaseToEndEffector]() {
+        const int connection = accept(listener, nullptr, nullptr);
+        if(connection >= 0)
+        {
+            std::unique_ptr<HandEyeTransformChain> transformChain(
+                new HandEyeTransformChain(transformEndEffectorToCamera, transformBaseToEndEffector));
+            handleServiceConnection(connection, std::move(transformChain));
+        }
+    });
+
+    /*
+	The service thread must be joined on every path, also when connecting or a round-trip fails. Closing the
+	client ends the service connection, and shutting down the listener wakes an accept that never got one.
+	*/
+    int client = -1;
+    const auto stopService = [&service, &client, listener, &socketPath]() {
+        if(client >= 0)
+        {
+            close(client);
+        }
+        shutdown(listener, SHUT_RDWR);
+        service.join();
+        close(listener);
+        unlink(socketPath.c_str());
+    };
+
+    try
+    {
+        client = connectToSocket(socketPath);
+
+        const Eigen::Matrix<double, 4, 4, Eigen::RowMajor> baseToEndEffector = transformBaseToEndEffector.matrix();
+        const ServiceMessageHeader poseHeader{ static_cast<uint32_t>(ServiceCommand::setBaseToEndEffector), 0 };
+
+        std::cout << "Round-trips per batch size: " << numRoundTrips << std::endl;
+        std::cout << std::left << std::setw(14) << "Batch size" << std::setw(14) << "Median" << std::setw(14) << "P99"
+                  << std::setw(14) << "Max"
+                  << "Throughput" << std::endl;
+
+        for(const auto batchSize : batchSizes)
+        {
+            const Eigen::Matrix3Xd pointsInCameraFrame = Eigen::Matrix3Xd::Random(3, batchSize) * 500.0;
+            Eigen::Matrix3Xd pointsInBaseFrame(3, batchSize);
+            const ServiceMessageHeader pointsHeader{ static_cast<uint32_t>(ServiceCommand::transformPoints),
+                                                     static_cast<uint32_t>(batchSize) };
+            ServiceMessageHeader replyHeader{};
+
+            std::vector<double> roundTripTimes;
+            roundTripTimes.reserve(numRoundTrips);
+            const size_t numWarmupRoundTrips = 10;
+
+            for(size_t i = 0; i < numWarmupRoundTrips + numRoundTrips; i++)
+            {
+                const auto beforeRoundTrip = std::chrono::high_resolution_clock::now();
+                if(!writeAll(client, &poseHeader, sizeof(poseHeader))
+                   || !writeAll(client, baseToEndEffector.data(), sizeof(double) * baseToEndEffector.size())
+                   || !writeAll(client, &pointsHeader, sizeof(pointsHeader))
+                   || !writeAll(client, pointsInCameraFrame.data(), sizeof(double) * pointsInCameraFrame.size())
+                   || !readAll(client, &replyHeader, sizeof(replyHeader))
+                   || !readAll(client, pointsInBaseFrame.data(), sizeof(double) * pointsInBaseFrame.size()))
+                {
+                    throw std::runtime_error("Lost connection to the picking point service");
+                }
+                const auto afterRoundTrip = std::chrono::high_resolution_clock::now();
+
+                if(i >= numWarmupRoundTrips)
+                {
+                    roundTripTimes.push_back(
+                        std::chrono::duration_cast<Microseconds>(afterRoundTrip - beforeRoundTrip).count());
+                }
+            }
+
+            std::sort(roundTripTimes.begin(), roundTripTimes.end());
+            const auto median = roundTripTimes.at(roundTripTimes.size() / 2);
+            const auto p99 = roundTripTimes.at(std::min(roundTripTimes.size() - 1, roundTripTimes.size() * 99 / 100));
+            const auto totalTime = std::accumulate(roundTripTimes.begin(), roundTripTimes.end(), 0.0);
+            const auto pointsPerSecond = static_cast<double>(batchSize * roundTripTimes.size()) / (totalTime * 1e-6);
+
+            std::cout << std::left << std::fixed << std::setprecision(1) << std::setw(14) << batchSize << std::setw(14)
+                      << (std::to_string(static_cast<int>(std::round(median))) + " us") << std::setw(14)
+                      << (std::to_string(static_cast<int>(std::round(p99))) + " us") << std::setw(14)
+                      << (std::to_string(static_cast<int>(std::round(roundTripTimes.back()))) + " us")
+                      << pointsPerSecond / 1e6 << " Mpoints/s" << std::endl;
+        }
+    }
+    catch(...)
+    {
+        stopService();
+        throw;
+    }
+
+    stopService();
+}
+#endif
@@ -1,9 +1,19 @@
 /*
 This example shows how to import a Zivid point cloud from a .ZDF file, iterate through, and extract individual points.
+
+The points are first extracted into separate contiguous x, y, z, rgb, contrast
+and valid mask arrays in one parallel pass, so that loops over a single
+property, like the averages below, run over plain arrays that the compiler can
+vectorize.
 */
 
 #include <Zivid/Zivid.h>
 
+#include <PointCloudArrays.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 
 int main()
@@ -23,6 +33,28 @@ int main()
         std::cout << "Number of points: " << pointCloud.size() << "\n"
                   << "Height: " << pointCloud.height() << ", Width: " << pointCloud.width() << std::endl;
 
+        // Extracting the points into one array per property. Passing the same arrays for later frames reuses them
+        Utils::PointCloudArrays arrays;
+        const auto beforeExtraction = std::chrono::steady_clock::now();
+        Utils::extractArrays(pointCloud, arrays);
+        const auto afterExtraction = std::chrono::steady_clock::now();
+        std::cout << "Extracted the point cloud into arrays in "
+                  << std::chrono::duration<double, std::milli>(afterExtraction - beforeExtraction).count() << " ms"
+                  << std::endl;
+
+        // Averaging z and contrast over the valid points, one property at a time
+        size_t numValid = 0;
+        double sumZ = 0.0;
+        double sumContrast = 0.0;
+        for(size_t i = 0; i < arrays.size(); i++)
+        {
+            numValid += arrays.valid[i];
+            sumZ += arrays.valid[i] != 0 ? arrays.z[i] : 0.0F;
+            sumContrast += arrays.valid[i] != 0 ? arrays.contrast[i] : 0.0F;
+        }
+        std::cout << "Valid points: " << numValid << ", mean Z: " << (numValid > 0 ? sumZ / numValid : 0.0)
+                  << ", mean contrast: " << (numValid > 0 ? sumContrast / numValid : 0.0) << std::endl;
+
         // Iterating over the point cloud and displaying X, Y, Z, R, G, B, and Contrast for central 10 x 10 pixels
         const size_t pixelsToDisplay = 10;
         for(size_t i = (pointCloud.height() - pixelsToDisplay) / 2; i < (pointCloud.height() + pixelsToDisplay) / 2;
@@ -31,12 +63,13 @@ int main()
             for(size_t j = (pointCloud.width() - pixelsToDisplay) / 2; j < (pointCloud.width() + pixelsToDisplay) / 2;
                 j++)
             {
-                const auto &point = pointCloud(i, j);
+                const size_t index = i * arrays.width + j;
+                const uint32_t rgb = arrays.rgb[index];
 
                 std::cout << std::setprecision(1) << std::fixed << "Values at pixel (" << i << ", " << j << "):"
-                          << "    X:" << point.x << "  Y:" << point.y << "  Z:" << point.z
-                          << "    R:" << static_cast<int>(point.red()) << "  G:" << static_cast<int>(point.green())
-                          << "  B:" << static_cast<int>(point.blue()) << "    Contrast:" << point.contrast << std::endl;
+                          << "    X:" << arrays.x[index] << "  Y:" << arrays.y[index] << "  Z:" << arrays.z[index]
+                          << "    R:" << ((rgb >> 16U) & 0xFFU) << "  G:" << ((rgb >> 8U) & 0xFFU)
+                          << "  B:" << (rgb & 0xFFU) << "    Contrast:" << arrays.contrast[index] << std::endl;
             }
         }
     }
@@ -0,0 +1,507 @@
+/*
+This example shows how to compute statistics over whole Zivid point clouds from .ZDF files, and write them as
+JSON, for example to monitor the scene and the health of the camera over many captures.
+
+For every file, the sample reports the number of valid points, the bounding box, centroid and covariance of the
+valid points, histograms of z and contrast, and the mean red, green and blue values. All of them are computed in a
+single pass over the points: the cloud is split into one contiguous range per core, every range fills its own
+partial statistics, and the partial statistics are merged at the end. The next file is loaded in the background
+while the statistics of the current one are computed.
+
+Pass .ZDF files, or directories that hold them, on the command line. The JSON is written as each file is done, so
+that a long run over a large directory does not keep all results in memory.
+*/
+
+#include <Zivid/Zivid.h>
+
+#include <ParallelRanges.h>
+
+#include <clipp.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <dirent.h>
+#    include <sys/stat.h>
+#elif defined(_WIN32)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#endif
+
+struct HistogramRange
+{
+    float min;
+    float max;
+    size_t numBins;
+};
+
+/*
+Histogram with numBins equally wide bins between min and max. Values outside of the range are counted in below
+and above, so that every valid point is accounted for.
+*/
+struct Histogram
+{
+    explicit Histogram(const HistogramRange &range)
+        : min{ range.min }
+        , max{ range.max }
+        , binsPerUnit{ static_cast<float>(range.numBins) / (range.max - range.min) }
+        , counts(range.numBins, 0)
+    {}
+
+    void add(const float value)
+    {
+        if(value < min)
+        {
+            ++below;
+        }
+        else if(value >= max)
+        {
+            ++above;
+        }
+        else
+        {
+            // Rounding can put a value just below max into the bin after the last one
+            const auto bin = static_cast<size_t>((value - min) * binsPerUnit);
+            ++counts[std::min(bin, counts.size() - 1)];
+        }
+    }
+
+    void merge(const Histogram &other)
+    {
+        for(size_t bin = 0; bin < counts.size(); ++bin)
+        {
+            counts[bin] += other.counts[bin];
+        }
+        below += other.below;
+        above += other.above;
+    }
+
+    float min;
+    float max;
+    float binsPerUnit;
+    std::vector<uint64_t> counts;
+    uint64_t below = 0;
+    uint64_t above = 0;
+};
+
+/*
+Statistics of the valid points, which are the points with a z value. The sums are kept in double precision, and
+the centroid and covariance are computed from them after all partial statistics have been merged.
+*/
+struct CloudStatistics
+{
+    CloudStatistics(const HistogramRange &zRange, const HistogramRange &contrastRange)
+        : zHistogram{ zRange }
+        , contrastHistogram{ contrastRange }
+    {
+        min.fill(std::numeric_limits<float>::infinity());
+        max.fill(-std::numeric_limits<float>::infinity());
+    }
+
+    void add(const Zivid::Point &point)
+    {
+        if(std::isnan(point.z))
+        {
+            return;
+        }
+
+        const std::array<float, 3> xyz{ { point.x, point.y, point.z } };
+        for(size_t axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], xyz[axis]);
+            max[axis] = std::max(max[axis], xyz[axis]);
+            sum[axis] += xyz[axis];
+        }
+        sumOfProducts[0] += static_cast<double>(point.x) * point.x;
+        sumOfProducts[1] += static_cast<double>(point.x) * point.y;
+        sumOfProducts[2] += static_cast<double>(point.x) * point.z;
+        sumOfProducts[3] += static_cast<double>(point.y) * point.y;
+        sumOfProducts[4] += static_cast<double>(point.y) * point.z;
+        sumOfProducts[5] += static_cast<double>(point.z) * point.z;
+        sumOfColors[0] += point.red();
+        sumOfColors[1] += point.green();
+        sumOfColors[2] += point.blue();
+        zHistogram.add(point.z);
+        if(!std::isnan(point.contrast))
+        {
+            contrastHistogram.add(point.contrast);
+        }
+        ++numValid;
+    }
+
+    void merge(const CloudStatistics &other)
+    {
+        for(size_t axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], other.min[axis]);
+            max[axis] = std::max(max[axis], other.max[axis]);
+            sum[axis] += other.sum[axis];
+            sumOfColors[axis] += other.sumOfColors[axis];
+        }
+        for(size_t i = 0; i < sumOfProducts.size(); ++i)
+        {
+            sumOfProducts[i] += other.sumOfProducts[i];
+        }
+        zHistogram.merge(other.zHistogram);
+        contrastHistogram.merge(other.contrastHistogram);
+        numValid += other.numValid;
+    }
+
+    uint64_t numValid = 0;
+    std::array<float, 3> min;
+    std::array<float, 3> max;
+    std::array<double, 3> sum{ { 0.0, 0.0, 0.0 } };
+    // xx, xy, xz, yy, yz and zz
+    std::array<double, 6> sumOfProducts{ { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 } };
+    std::array<uint64_t, 3> sumOfColors{ { 0, 0, 0 } };
+    Histogram zHistogram;
+    Histogram contrastHistogram;
+};
+
+std::vector<std::string> findZDFFiles(const std::vector<std::string> &);
+CloudStatistics computeStatistics(const Zivid::PointCloud &, const HistogramRange &, const HistogramRange &);
+void writeStatisticsJSON(std::ostream &, const std::string &, const Zivid::PointCloud &, const CloudStatistics &);
+void writeErrorJSON(std::ostream &, const std::string &, const std::string &);
+void writeHistogramJSON(std::ostream &, const Histogram &);
+std::string toJSON(const std::string &);
+std::string toJSON(double);
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::vector<std::string> paths;
+        std::string outputFile = "ZDFStatistics.json";
+        HistogramRange zRange{ 0.0F, 3000.0F, 100 };
+        HistogramRange contrastRange{ 0.0F, 20.0F, 100 };
+
+        auto cli = (clipp::opt_values("paths", paths) % "ZDF files, or directories of ZDF files (default Zivid3D.zdf)",
+                    (clipp::option("-o", "--output") & clipp::value("file", outputFile))
+                        % "The JSON file to write (default ZDFStatistics.json)",
+                    (clipp::option("--z-range") & clipp::value("min", zRange.min) & clipp::value("max", zRange.max))
+                        % "Range of the z histogram in mm (default 0 3000)",
+                    (clipp::option("--contrast-range") & clipp::value("min", contrastRange.min)
+                     & clipp::value("max", contrastRange.max))
+                        % "Range of the contrast histogram (default 0 20)",
+                    (clipp::option("--bins") & clipp::value("count", zRange.numBins))
+                        % "Number of bins of each histogram (default 100)");
+        if(!parse(argc, argv, cli))
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            return EXIT_FAILURE;
+        }
+        contrastRange.numBins = zRange.numBins;
+        if(zRange.numBins == 0 || !(zRange.min < zRange.max) || !(contrastRange.min < contrastRange.max))
+        {
+            throw std::invalid_argument("The histograms need at least one bin, and a minimum below the maximum");
+        }
+        if(paths.empty())
+        {
+            paths.emplace_back("Zivid3D.zdf");
+        }
+
+        Zivid::Application zivid;
+
+        const auto files = findZDFFiles(paths);
+        std::cout << "Computing statistics for " << files.size() << " files, writing them to " << outputFile
+                  << std::endl;
+
+        std::ofstream json(outputFile);
+        if(!json)
+        {
+            throw std::runtime_error("Could not open " + outputFile + " for writing");
+        }
+        json << "{\n  \"files\": [";
+
+        const auto loadPointCloud = [](const std::string &fileName) {
+            return Zivid::Frame(fileName).getPointCloud();
+        };
+
+        const auto beforeFiles = std::chrono::steady_clock::now();
+        size_t numFailed = 0;
+        std::future<Zivid::PointCloud> nextPointCloud;
+        if(!files.empty())
+        {
+            nextPointCloud = std::async(std::launch::async, loadPointCloud, files.front());
+        }
+        for(size_t i = 0; i < files.size(); ++i)
+        {
+            json << (i == 0 ? "\n    " : ",\n    ");
+            try
+            {
+                const auto pointCloud = nextPointCloud.get();
+                if(i + 1 < files.size())
+                {
+                    nextPointCloud = std::async(std::launch::async, loadPointCloud, files[i + 1]);
+                }
+
+                const auto beforeStatistics = std::chrono::steady_clock::now();
+                const auto statistics = computeStatistics(pointCloud, zRange, contrastRange);
+                const auto afterStatistics = std::chrono::steady_clock::now();
+
+                std::cout << files[i] << ": " << statistics.numValid << " of " << pointCloud.size()
+                          << " points valid, computed in "
+                          << std::chrono::duration<double, std::milli>(afterStatistics - beforeStatistics).count()
+                          << " ms" << std::endl;
+                writeStatisticsJSON(json, files[i], pointCloud, statistics);
+            }
+            catch(const std::exception &e)
+            {
+                // A file that cannot be read is reported, and the remaining files are still processed
+                if(i + 1 < files.size() && !nextPointCloud.valid())
+                {
+                    nextPointCloud = std::async(std::launch::async, loadPointCloud, files[i + 1]);
+                }
+                std::cerr << "Could not process " << files[i] << ": " << Zivid::toString(e) << std::endl;
+                writeErrorJSON(json, files[i], Zivid::toString(e));
+                ++numFailed;
+            }
+        }
+        json << "\n  ]\n}\n";
+        const auto afterFiles = std::chrono::steady_clock::now();
+
+        std::cout << "Processed " << files.size() - numFailed << " of " << files.size() << " files in "
+                  << std::chrono::duration<double, std::milli>(afterFiles - beforeFiles).count() << " ms"
+                  << std::endl;
+        if(numFailed > 0)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    catch(const std::exception &e)
+    {
+        std::cerr << "Error: " << Zivid::toString(e) << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+std::vector<std::string> findZDFFiles(const std::vector<std::string> &paths)
+{
+    /*
+	Paths to directories are replaced with the .ZDF files in them, in alphabetical order. Other paths are used as
+	they are.
+	*/
+
+    std::vector<std::string> files;
+    for(const auto &path : paths)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        struct stat status = {};
+        const bool isDirectory = stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+#elif defined(_WIN32)
+        const auto attributes = GetFileAttributesA(path.c_str());
+        const bool isDirectory = attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+        const bool isDirectory = false;
+#endif
+        if(!isDirectory)
+        {
+            files.emplace_back(path);
+            continue;
+        }
+
+        std::vector<std::string> names;
+#if defined(__unix__) || defined(__APPLE__)
+        DIR *directory = opendir(path.c_str());
+        if(directory == nullptr)
+        {
+            throw std::runtime_error("Could not open the directory " + path);
+        }
+        while(const dirent *entry = readdir(directory))
+        {
+            names.emplace_back(entry->d_name);
+        }
+        closedir(directory);
+#elif defined(_WIN32)
+        WIN32_FIND_DATAA entry;
+        const auto search = FindFirstFileA((path + "\\*").c_str(), &entry);
+        if(search == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Could not open the directory " + path);
+        }
+        do
+        {
+            names.emplace_back(entry.cFileName);
+        } while(FindNextFileA(search, &entry) != 0);
+        FindClose(search);
+#endif
+
+        std::sort(names.begin(), names.end());
+        for(const auto &name : names)
+        {
+            std::string extension = name.size() > 4 ? name.substr(name.size() - 4) : "";
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            if(extension == ".zdf")
+            {
+                files.emplace_back(path + "/" + name);
+            }
+        }
+    }
+    return files;
+}
+
+CloudStatistics computeStatistics(const Zivid::PointCloud &pointCloud,
+                                  const HistogramRange &zRange,
+                                  const HistogramRange &contrastRange)
+{
+    /*
+	Every range accumulates into its own local statistics, which are stored for the merge only when the range is
+	done. Accumulating straight into the shared vector would make the threads write to neighbouring memory for
+	every point.
+	*/
+
+    const Zivid::Point *points = pointCloud.dataPtr();
+    const size_t numPoints = pointCloud.size();
+    const size_t numRanges = Utils::computeNumRanges(numPoints);
+    std::vector<CloudStatistics> partials(numRanges, CloudStatistics{ zRange, contrastRange });
+
+    const auto computeRange = [&](const size_t range, const size_t begin, const size_t end) {
+        CloudStatistics partial{ zRange, contrastRange };
+        for(size_t i = begin; i < end; ++i)
+        {
+            partial.add(points[i]);
+        }
+        partials.at(range) = std::move(partial);
+    };
+    Utils::forEachRange(numPoints, numRanges, computeRange);
+
+    auto statistics = std::move(partials.front());
+    for(size_t range = 1; range < numRanges; ++range)
+    {
+        statistics.merge(partials[range]);
+    }
+    return statistics;
+}
+
+void writeStatisticsJSON(std::ostream &json,
+                         const std::string &fileName,
+                         const Zivid::PointCloud &pointCloud,
+                         const CloudStatistics &statistics)
+{
+    /*
+	Values that are not defined when the cloud has no valid points, such as the centroid, are written as null.
+	The covariance is the population covariance of the valid points, in square millimeters.
+	*/
+
+    const auto numValid = static_cast<double>(statistics.numValid);
+    const auto nan = std::numeric_limits<double>::quiet_NaN();
+    std::array<double, 3> centroid{ { nan, nan, nan } };
+    std::array<double, 3> meanColor{ { nan, nan, nan } };
+    for(size_t axis = 0; axis < 3; ++axis)
+    {
+        if(statistics.numValid > 0)
+        {
+            centroid[axis] = statistics.sum[axis] / numValid;
+            meanColor[axis] = static_cast<double>(statistics.sumOfColors[axis]) / numValid;
+        }
+    }
+
+    const std::array<std::array<size_t, 3>, 3> productIndex{ { { { 0, 1, 2 } }, { { 1, 3, 4 } }, { { 2, 4, 5 } } } };
+    const auto covariance = [&](const size_t row, const size_t column) {
+        return statistics.sumOfProducts[productIndex[row][column]] / numValid - centroid[row] * centroid[column];
+    };
+    const auto boundValue = [&statistics](const float value) {
+        return statistics.numValid > 0 ? static_cast<double>(value) : std::numeric_limits<double>::quiet_NaN();
+    };
+
+    json << "{\n      \"file\": " << toJSON(fileName) << ",\n      \"width\": " << pointCloud.width()
+         << ",\n      \"height\": " << pointCloud.height() << ",\n      \"points\": " << pointCloud.size()
+         << ",\n      \"validPoints\": " << statistics.numValid << ",\n      \"validRatio\": "
+         << toJSON(pointCloud.size() > 0 ? numValid / static_cast<double>(pointCloud.size()) : nan);
+
+    json << ",\n      \"boundingBox\": { \"min\": [" << toJSON(boundValue(statistics.min[0])) << ", "
+         << toJSON(boundValue(statistics.min[1])) << ", " << toJSON(boundValue(statistics.min[2])) << "], \"max\": ["
+         << toJSON(boundValue(statistics.max[0])) << ", " << toJSON(boundValue(statistics.max[1])) << ", "
+         << toJSON(boundValue(statistics.max[2])) << "] }";
+
+    json << ",\n      \"centroid\": [" << toJSON(centroid[0]) << ", " << toJSON(centroid[1]) << ", "
+         << toJSON(centroid[2]) << "],\n      \"covariance\": [";
+    for(size_t row = 0; row < 3; ++row)
+    {
+        json << (row == 0 ? "[" : ", [") << toJSON(covariance(row, 0)) << ", " << toJSON(covariance(row, 1)) << ", "
+             << toJSON(covariance(row, 2)) << "]";
+    }
+
+    json << "],\n      \"meanColor\": { \"r\": " << toJSON(meanColor[0]) << ", \"g\": " << toJSON(meanColor[1])
+         << ", \"b\": " << toJSON(meanColor[2]) << " }";
+
+    json << ",\n      \"zHistogram\": ";
+    writeHistogramJSON(json, statistics.zHistogram);
+    json << ",\n      \"contrastHistogram\": ";
+    writeHistogramJSON(json, statistics.contrastHistogram);
+    json << "\n    }";
+}
+
+void writeErrorJSON(std::ostream &json, const std::string &fileName, const std::string &message)
+{
+    json << "{\n      \"file\": " << toJSON(fileName) << ",\n      \"error\": " << toJSON(message) << "\n    }";
+}
+
+void writeHistogramJSON(std::ostream &json, const Histogram &histogram)
+{
+    json << "{ \"min\": " << toJSON(histogram.min) << ", \"max\": " << toJSON(histogram.max)
+         << ", \"below\": " << histogram.below << ", \"above\": " << histogram.above << ", \"counts\": [";
+    for(size_t bin = 0; bin < histogram.counts.size(); ++bin)
+    {
+        json << (bin == 0 ? "" : ", ") << histogram.counts[bin];
+    }
+    json << "] }";
+}
+
+std::string toJSON(const std::string &text)
+{
+    std::ostringstream quoted;
+    quoted << '"';
+    for(const char c : text)
+    {
+        switch(c)
+        {
+            case '"': quoted << "\\\""; break;
+            case '\\': quoted << "\\\\"; break;
+            case '\n': quoted << "\\n"; break;
+            case '\r': quoted << "\\r"; break;
+            case '\t': quoted << "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20)
+                {
+                    quoted << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xF] << "0123456789abcdef"[c & 0xF];
+                }
+                else
+                {
+                    quoted << c;
+                }
+        }
+    }
+    quoted << '"';
+    return quoted.str();
+}
+
+std::string toJSON(const double value)
+{
+    // JSON has no NaN or infinity
+    if(!std::isfinite(value))
+    {
+        return "null";
+    }
+    std::ostringstream number;
+    number.precision(10);
+    number << value;
+    return number.str();
+}
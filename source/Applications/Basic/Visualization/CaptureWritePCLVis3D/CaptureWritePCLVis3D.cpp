@@ -1,22 +1,243 @@
 /*
 This example shows how capture a Zivid point cloud, save it to a .PCD file format,
 and visualize it.
+
+The point cloud is converted to PCL on all available cores, either organized
+(one point per pixel, missing points are NaN) or dense (missing points removed).
+
+The .PCD file (and optionally a .PLY file) is streamed straight from the Zivid
+point cloud in large chunks, without building another copy of the cloud. The
+files are written by a background writer while the cloud is on screen. Run
+with --compare-writers to time this against saving through PCL and against
+Zivid::Frame::save. With --compressed, the fields are compressed with
+pcl::lzfCompress, the LZF compressor that PCL itself uses for binary_compressed
+.PCD files.
+
+The PCL visualizer waits for window events between frames, at most --max-fps
+frames per second, instead of keeping a core busy. With --live, new frames are
+captured while the visualizer is open and shown as they arrive.
+
+With --contrast, the saved .PCD file also holds the contrast of every point,
+which can be used as a confidence value. PCL reads such a file into the
+PointXYZRGBContrast point type defined below, so downstream filtering does not
+need to load the much larger .ZDF file again. --min-contrast reads the saved
+file back that way and keeps only the points above the given contrast.
 */
 
 #include <Zivid/CloudVisualizer.h>
 #include <Zivid/Zivid.h>
 
+// Lets the PCL templates, such as the .PCD reader and writer, be instantiated for the custom point type
+#define PCL_NO_PRECOMPILE
+#include <pcl/io/lzf.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/pcl_macros.h>
 #include <pcl/point_types.h>
-#include <pcl/visualization/cloud_viewer.h>
+#include <pcl/register_point_struct.h>
+#include <pcl/visualization/pcl_visualizer.h>
 
+#include <BackgroundWriter.h>
+#include <PCLConversion.h>
+#include <PackedRGB.h>
+#include <ViewerLoop.h>
+
+#include <clipp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iterator>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class PCDEncoding
+{
+    binary,
+    binaryCompressed
+};
+
+enum class PointFields
+{
+    xyzrgb,
+    xyzrgbContrast
+};
+
+/*
+pcl::PointXYZRGB with the contrast of the Zivid point. The contrast fits in the padding after rgb, so the
+point takes 32 bytes like pcl::PointXYZRGB.
+*/
+struct EIGEN_ALIGN16 PointXYZRGBContrast
+{
+    PCL_ADD_POINT4D;
+    PCL_ADD_RGB;
+    float contrast;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+POINT_CLOUD_REGISTER_POINT_STRUCT(
+    PointXYZRGBContrast,
+    (float, x, x)(float, y, y)(float, z, z)(float, rgb, rgb)(float, contrast, contrast))
+
+void setPoint(const Zivid::Point &, PointXYZRGBContrast &);
+void writePCD(const Zivid::PointCloud &, const std::string &, PCDEncoding, bool, PointFields);
+void writePLY(const Zivid::PointCloud &, const std::string &, bool);
+template<typename WriteRecord>
+void writeRecords(std::ofstream &, const Zivid::PointCloud &, bool, size_t, WriteRecord);
+std::string makePCDHeader(size_t, size_t, const std::string &, PointFields);
+std::ofstream openForWriting(const std::string &);
+void filterByContrast(const std::string &, float);
+void compareWriters(const Zivid::Frame &, const Zivid::PointCloud &, size_t);
+template<typename Function>
+double measureMedianMilliseconds(size_t, Function);
+
+/*
+Captures frames on its own thread while the PCL visualizer is open. Each frame is converted in place into
+a cloud that is not on screen, and handed to the viewer by swapping pointers, so a new frame is neither
+copied again nor allocated. When the viewer is slower than the camera, only the latest frame is shown.
+*/
+class LiveCapture
+{
+public:
+    LiveCapture(Zivid::Camera &camera, const Utils::CloudLayout layout)
+        : m_camera(camera)
+        , m_layout(layout)
+        , m_capturing(new pcl::PointCloud<pcl::PointXYZRGB>)
+        , m_ready(new pcl::PointCloud<pcl::PointXYZRGB>)
+        , m_thread([this] { run(); })
+    {}
+
+    LiveCapture(const LiveCapture &) = delete;
+    LiveCapture &operator=(const LiveCapture &) = delete;
+
+    ~LiveCapture()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_thread.join();
+    }
+
+    // Swaps the displayed cloud with the latest captured one. Returns false if no new frame has arrived
+    bool takeLatest(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &displayed)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+        if(!m_hasNewCloud)
+        {
+            return false;
+        }
+        std::swap(displayed, m_ready);
+        m_hasNewCloud = false;
+        return true;
+    }
+
+    size_t numCaptured() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numCaptured;
+    }
+
+private:
+    void run()
+    {
+        try
+        {
+            while(true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if(m_stopping)
+                    {
+                        return;
+                    }
+                }
+
+                const auto frame = m_camera.capture();
+                Utils::convertToPCL(frame.getPointCloud(), *m_capturing, m_layout);
 
-int main()
+                std::lock_guard<std::mutex> lock(m_mutex);
+                std::swap(m_capturing, m_ready);
+                m_hasNewCloud = true;
+                ++m_numCaptured;
+            }
+        }
+        catch(const std::exception &)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+        }
+    }
+
+    Zivid::Camera &m_camera;
+    const Utils::CloudLayout m_layout;
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr m_capturing;
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr m_ready;
+    mutable std::mutex m_mutex;
+    bool m_hasNewCloud = false;
+    bool m_stopping = false;
+    size_t m_numCaptured = 0;
+    std::exception_ptr m_error;
+    std::thread m_thread;
+};
+
+int main(int argc, char **argv)
 {
     try
     {
         std::string filenamePCD = "Zivid3D.pcd";
+        std::string filenamePLY = "Zivid3D.ply";
+        auto layout = Utils::CloudLayout::organized;
+        auto encoding = PCDEncoding::binary;
+        bool skipNaN = false;
+        bool savePLY = false;
+        bool runWriterComparison = false;
+        size_t numRepetitions = 5;
+        bool live = false;
+        double maxFramesPerSecond = 30.0;
+        auto fields = PointFields::xyzrgb;
+        bool filterContrast = false;
+        float minContrast = 0.0F;
+
+        auto cli = (clipp::option("--dense").set(layout, Utils::CloudLayout::dense)
+                        % "Remove missing points instead of keeping the organized image layout",
+                    clipp::option("--compressed").set(encoding, PCDEncoding::binaryCompressed)
+                        % "Save the .PCD file as binary_compressed (LZF)",
+                    clipp::option("--skip-nan").set(skipNaN) % "Leave missing points out of the saved files",
+                    clipp::option("--ply").set(savePLY) % "Also save a binary .PLY file",
+                    (clipp::option("--compare-writers").set(runWriterComparison)
+                     & clipp::opt_value("repetitions", numRepetitions))
+                        % "Time the writers against PCL and Zivid, median of <repetitions> runs (default 5)",
+                    clipp::option("--live").set(live) % "Keep capturing and show new frames in the PCL visualizer",
+                    (clipp::option("--max-fps") & clipp::value("fps", maxFramesPerSecond))
+                        % "Frame rate limit of the PCL visualizer",
+                    clipp::option("--contrast").set(fields, PointFields::xyzrgbContrast)
+                        % "Also save the contrast of every point in the .PCD file",
+                    (clipp::option("--min-contrast").set(filterContrast) & clipp::value("contrast", minContrast))
+                        % "Read the saved .PCD file back and keep the points above this contrast (implies --contrast)");
+        if(!parse(argc, argv, cli) || numRepetitions == 0)
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(filterContrast)
+        {
+            fields = PointFields::xyzrgbContrast;
+        }
 
         Zivid::Application zivid;
 
@@ -43,43 +264,85 @@ int main()
 
         auto pointCloud = frame.getPointCloud();
 
-        // Creating a PointCloud structure
-        pcl::PointCloud<pcl::PointXYZRGB> cloud;
-
-        // Filling in the cloud data
-        cloud.width = pointCloud.width();
-        cloud.height = pointCloud.height();
-        cloud.is_dense = false;
-        cloud.points.resize(cloud.width * cloud.height);
+        // Filling in the cloud data directly in the cloud that is shared with the viewer
+        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloudPTR(new pcl::PointCloud<pcl::PointXYZRGB>);
+        const auto beforeConversion = std::chrono::steady_clock::now();
+        Utils::convertToPCL(pointCloud, *cloudPTR, layout);
+        const auto afterConversion = std::chrono::steady_clock::now();
+        std::cout << "Converted " << cloudPTR->points.size() << " of " << pointCloud.size() << " points to PCL in "
+                  << std::chrono::duration<double, std::milli>(afterConversion - beforeConversion).count() << " ms"
+                  << std::endl;
 
-        for(size_t i = 0; i < cloud.points.size(); ++i)
+        //Saving to a .PCD file format in the background, while the cloud is shown in the PCL visualizer
+        Utils::BackgroundWriter writer(2, 2, Utils::BackgroundWriter::OverflowPolicy::block);
+        const auto numSavedPoints =
+            skipNaN ? Utils::countValidPoints(pointCloud.dataPtr(), pointCloud.dataPtr() + pointCloud.size())
+                    : pointCloud.size();
+        std::cerr << "Saving " << numSavedPoints << " data points to " + filenamePCD << " in the background"
+                  << std::endl;
+        auto savePCD = writer.submit([&pointCloud, &filenamePCD, encoding, skipNaN, fields]() {
+            writePCD(pointCloud, filenamePCD, encoding, skipNaN, fields);
+        });
+        std::future<void> savePLYFile;
+        if(savePLY)
         {
-            auto point = pointCloud.operator()(i);
-
-            cloud.points[i].x = point.x;       // NOLINT(cppcoreguidelines-pro-type-union-access)
-            cloud.points[i].y = point.y;       // NOLINT(cppcoreguidelines-pro-type-union-access)
-            cloud.points[i].z = point.z;       // NOLINT(cppcoreguidelines-pro-type-union-access)
-            cloud.points[i].r = point.red();   // NOLINT(cppcoreguidelines-pro-type-union-access)
-            cloud.points[i].g = point.green(); // NOLINT(cppcoreguidelines-pro-type-union-access)
-            cloud.points[i].b = point.blue();  // NOLINT(cppcoreguidelines-pro-type-union-access)
+            std::cerr << "Saving to " + filenamePLY << " in the background" << std::endl;
+            savePLYFile =
+                writer.submit([&pointCloud, &filenamePLY, skipNaN]() { writePLY(pointCloud, filenamePLY, skipNaN); });
         }
 
         //Simple Cloud Visualization
-        pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloudPTR(new pcl::PointCloud<pcl::PointXYZRGB>);
-        *cloudPTR = cloud;
-
         std::cout << "Run the PCL visualizer. Block until window closes" << std::endl;
-        pcl::visualization::CloudViewer viewer("Simple Cloud Viewer");
-        viewer.showCloud(cloudPTR);
+        pcl::visualization::PCLVisualizer viewer("Simple Cloud Viewer");
+        viewer.addPointCloud<pcl::PointXYZRGB>(
+            cloudPTR, pcl::visualization::PointCloudColorHandlerRGBField<pcl::PointXYZRGB>(cloudPTR), "cloud");
+        viewer.resetCamera();
         std::cout << "Press r to centre and zoom the viewer so that the entire cloud is visible" << std::endl;
         std::cout << "Press q to me exit the viewer application" << std::endl;
-        while(!viewer.wasStopped())
+
+        std::unique_ptr<LiveCapture> liveCapture;
+        if(live)
+        {
+            std::cout << "Capturing new frames while the PCL visualizer is open" << std::endl;
+            liveCapture.reset(new LiveCapture(camera, layout));
+        }
+        auto displayedCloud = cloudPTR;
+        size_t numShown = 0;
+        const auto showLatestCloud = [&liveCapture, &displayedCloud, &viewer, &numShown] {
+            if(liveCapture && liveCapture->takeLatest(displayedCloud))
+            {
+                viewer.updatePointCloud<pcl::PointXYZRGB>(
+                    displayedCloud,
+                    pcl::visualization::PointCloudColorHandlerRGBField<pcl::PointXYZRGB>(displayedCloud),
+                    "cloud");
+                ++numShown;
+            }
+        };
+        Utils::runViewerLoop(viewer, maxFramesPerSecond, showLatestCloud);
+        if(liveCapture)
+        {
+            const auto numCaptured = liveCapture->numCaptured();
+            liveCapture.reset();
+            std::cout << "Captured " << numCaptured << " live frames and showed " << numShown << " of them"
+                      << std::endl;
+        }
+
+        savePCD.get();
+        if(savePLYFile.valid())
+        {
+            savePLYFile.get();
+        }
+        std::cerr << "Saved " + filenamePCD << (savePLY ? " and " + filenamePLY : std::string{}) << std::endl;
+
+        if(filterContrast)
         {
+            filterByContrast(filenamePCD, minContrast);
         }
 
-        //Saving to a .PCD file format
-        std::cerr << "Saving " << cloud.points.size() << " data points to " + filenamePCD << std::endl;
-        pcl::io::savePCDFileBinary(filenamePCD, cloud);
+        if(runWriterComparison)
+        {
+            compareWriters(frame, pointCloud, numRepetitions);
+        }
     }
     catch(const std::exception &e)
     {
@@ -87,3 +350,315 @@ int main()
         return EXIT_FAILURE;
     }
 }
+
+void setPoint(const Zivid::Point &source, PointXYZRGBContrast &destination)
+{
+    destination.x = source.x;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.y = source.y;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.z = source.z;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.r = source.red();   // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.g = source.green(); // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.b = source.blue();  // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.a = 255;            // NOLINT(cppcoreguidelines-pro-type-union-access)
+    destination.contrast = source.contrast;
+}
+
+void writePCD(const Zivid::PointCloud &pointCloud,
+              const std::string &fileName,
+              const PCDEncoding encoding,
+              const bool skipNaN,
+              const PointFields fields)
+{
+    /*
+	Writes x, y, z and packed rgb as in pcl::PointXYZRGB, so that pcl::io::loadPCDFile reads the file back into
+	that point type, and with PointFields::xyzrgbContrast also the contrast, as in PointXYZRGBContrast. Without
+	skipNaN the file keeps the organized width and height of the point cloud.
+	*/
+
+    const Zivid::Point *points = pointCloud.dataPtr();
+    const size_t numPoints = skipNaN ? Utils::countValidPoints(points, points + pointCloud.size()) : pointCloud.size();
+    const size_t width = skipNaN ? numPoints : pointCloud.width();
+    const size_t height = skipNaN ? 1 : pointCloud.height();
+    const bool withContrast = fields == PointFields::xyzrgbContrast;
+    const size_t recordSize = withContrast ? 20 : 16;
+
+    auto file = openForWriting(fileName);
+    if(encoding == PCDEncoding::binary)
+    {
+        file << makePCDHeader(width, height, "binary", fields);
+        writeRecords(file, pointCloud, skipNaN, recordSize, [withContrast](const Zivid::Point &point, char *record) {
+            const uint32_t rgb = Utils::packRGB(point);
+            std::memcpy(record, &point.x, 4);
+            std::memcpy(record + 4, &point.y, 4);
+            std::memcpy(record + 8, &point.z, 4);
+            std::memcpy(record + 12, &rgb, 4);
+            if(withContrast) std::memcpy(record + 16, &point.contrast, 4);
+        });
+    }
+    else
+    {
+        // binary_compressed stores each field for all points after each other, compressed with LZF as one block
+        std::vector<uint8_t> fieldData(numPoints * recordSize);
+        uint8_t *x = fieldData.data();
+        uint8_t *y = x + numPoints * 4;
+        uint8_t *z = y + numPoints * 4;
+        uint8_t *rgb = z + numPoints * 4;
+        uint8_t *contrast = rgb + numPoints * 4;
+        size_t index = 0;
+        for(size_t i = 0; i < pointCloud.size(); i++)
+        {
+            const auto &point = points[i];
+            if(skipNaN && std::isnan(point.z)) continue;
+
+            const uint32_t packedRGB = Utils::packRGB(point);
+            std::memcpy(x + index * 4, &point.x, 4);
+            std::memcpy(y + index * 4, &point.y, 4);
+            std::memcpy(z + index * 4, &point.z, 4);
+            std::memcpy(rgb + index * 4, &packedRGB, 4);
+            if(withContrast) std::memcpy(contrast + index * 4, &point.contrast, 4);
+            index++;
+        }
+
+        // The output buffer is sized as in pcl::io::savePCDFileBinaryCompressed, which uses the same compressor
+        std::vector<uint8_t> compressed(fieldData.size() * 3 / 2 + 8);
+        const uint32_t compressedSize = pcl::lzfCompress(fieldData.data(),
+                                                         static_cast<unsigned int>(fieldData.size()),
+                                                         compressed.data(),
+                                                         static_cast<unsigned int>(compressed.size()));
+        if(compressedSize == 0) throw std::runtime_error("Failed to compress the point data for " + fileName);
+
+        const auto uncompressedSize = static_cast<uint32_t>(fieldData.size());
+        file << makePCDHeader(width, height, "binary_compressed", fields);
+        file.write(reinterpret_cast<const char *>(&compressedSize), sizeof(compressedSize));
+        file.write(reinterpret_cast<const char *>(&uncompressedSize), sizeof(uncompressedSize));
+        file.write(reinterpret_cast<const char *>(compressed.data()), compressedSize);
+    }
+
+    file.close();
+    if(!file) throw std::runtime_error("Failed to write " + fileName);
+}
+
+void writePLY(const Zivid::PointCloud &pointCloud, const std::string &fileName, const bool skipNaN)
+{
+    const Zivid::Point *points = pointCloud.dataPtr();
+    const size_t numPoints = skipNaN ? Utils::countValidPoints(points, points + pointCloud.size()) : pointCloud.size();
+    const uint16_t byteOrderProbe = 1;
+    const bool isLittleEndian = *reinterpret_cast<const uint8_t *>(&byteOrderProbe) == 1;
+
+    auto file = openForWriting(fileName);
+    file << "ply\n"
+         << "format " << (isLittleEndian ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+         << "element vertex " << numPoints << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n"
+         << "property uchar red\n"
+         << "property uchar green\n"
+         << "property uchar blue\n"
+         << "end_header\n";
+    writeRecords(file, pointCloud, skipNaN, 15, [](const Zivid::Point &point, char *record) {
+        std::memcpy(record, &point.x, 4);
+        std::memcpy(record + 4, &point.y, 4);
+        std::memcpy(record + 8, &point.z, 4);
+        record[12] = static_cast<char>(point.red());
+        record[13] = static_cast<char>(point.green());
+        record[14] = static_cast<char>(point.blue());
+    });
+
+    file.close();
+    if(!file) throw std::runtime_error("Failed to write " + fileName);
+}
+
+template<typename WriteRecord>
+void writeRecords(std::ofstream &file,
+                  const Zivid::PointCloud &pointCloud,
+                  const bool skipNaN,
+                  const size_t recordSize,
+                  WriteRecord writeRecord)
+{
+    /*
+	Encodes the points into a fixed buffer and writes it whenever it is full, so that the file is written
+	in large chunks straight from the point cloud.
+	*/
+
+    const size_t pointsPerChunk = 65536;
+    std::vector<char> buffer(pointsPerChunk * recordSize);
+    const Zivid::Point *points = pointCloud.dataPtr();
+
+    size_t numBuffered = 0;
+    for(size_t i = 0; i < pointCloud.size(); i++)
+    {
+        if(skipNaN && std::isnan(points[i].z)) continue;
+
+        writeRecord(points[i], buffer.data() + numBuffered * recordSize);
+        if(++numBuffered == pointsPerChunk)
+        {
+            file.write(buffer.data(), static_cast<std::streamsize>(numBuffered * recordSize));
+            numBuffered = 0;
+        }
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(numBuffered * recordSize));
+}
+
+std::string makePCDHeader(const size_t width,
+                          const size_t height,
+                          const std::string &dataEncoding,
+                          const PointFields fields)
+{
+    const bool withContrast = fields == PointFields::xyzrgbContrast;
+    std::ostringstream header;
+    header << "# .PCD v0.7 - Point Cloud Data file format\n"
+           << "VERSION 0.7\n"
+           << (withContrast ? "FIELDS x y z rgb contrast\n" : "FIELDS x y z rgb\n")
+           << (withContrast ? "SIZE 4 4 4 4 4\n" : "SIZE 4 4 4 4\n")
+           << (withContrast ? "TYPE F F F F F\n" : "TYPE F F F F\n")
+           << (withContrast ? "COUNT 1 1 1 1 1\n" : "COUNT 1 1 1 1\n")
+           << "WIDTH " << width << "\n"
+           << "HEIGHT " << height << "\n"
+           << "VIEWPOINT 0 0 0 1 0 0 0\n"
+           << "POINTS " << width * height << "\n"
+           << "DATA " << dataEncoding << "\n";
+    return header.str();
+}
+
+std::ofstream openForWriting(const std::string &fileName)
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if(!file) throw std::runtime_error("Failed to open " + fileName + " for writing");
+    return file;
+}
+
+void filterByContrast(const std::string &fileName, const float minContrast)
+{
+    /*
+	Stands in for downstream processing: the saved .PCD file is read into PointXYZRGBContrast through PCL's
+	own reader, and only the valid points with a contrast of at least minContrast are kept.
+	*/
+
+    const auto beforeLoad = std::chrono::steady_clock::now();
+    pcl::PointCloud<PointXYZRGBContrast> cloud;
+    if(pcl::io::loadPCDFile<PointXYZRGBContrast>(fileName, cloud) == -1)
+    {
+        throw std::runtime_error("Failed to read " + fileName);
+    }
+    const auto afterLoad = std::chrono::steady_clock::now();
+
+    pcl::PointCloud<PointXYZRGBContrast> filtered;
+    filtered.points.reserve(cloud.points.size());
+    std::copy_if(cloud.points.begin(),
+                 cloud.points.end(),
+                 std::back_inserter(filtered.points),
+                 [minContrast](const PointXYZRGBContrast &point) {
+                     return !std::isnan(point.z) && point.contrast >= minContrast;
+                 });
+    filtered.width = static_cast<uint32_t>(filtered.points.size());
+    filtered.height = 1;
+    filtered.is_dense = true;
+    const auto afterFilter = std::chrono::steady_clock::now();
+
+    std::cout << "Read " << cloud.points.size() << " points with contrast from " << fileName << " in "
+              << std::chrono::duration<double, std::milli>(afterLoad - beforeLoad).count() << " ms, kept "
+              << filtered.points.size() << " points with contrast >= " << minContrast << " in "
+              << std::chrono::duration<double, std::milli>(afterFilter - afterLoad).count() << " ms" << std::endl;
+}
+
+void compareWriters(const Zivid::Frame &frame, const Zivid::PointCloud &pointCloud, const size_t numRepetitions)
+{
+    /*
+	Times every way of saving the point cloud in this sample, including the PCL conversion that the PCL path
+	needs first. The rate is the size of the written file divided by the median time.
+	*/
+
+    struct Writer
+    {
+        std::string name;
+        std::string fileName;
+        std::function<void()> write;
+    };
+
+    const std::vector<Writer> writers{
+        { "PCL convert + savePCDFileBinary",
+          "WriterComparison_pcl.pcd",
+          [&pointCloud]() {
+              pcl::PointCloud<pcl::PointXYZRGB> cloud;
+              Utils::convertToPCL(pointCloud, cloud, Utils::CloudLayout::organized);
+              pcl::io::savePCDFileBinary("WriterComparison_pcl.pcd", cloud);
+          } },
+        { "PCL convert + savePCDFileBinaryCompressed",
+          "WriterComparison_pcl_compressed.pcd",
+          [&pointCloud]() {
+              pcl::PointCloud<pcl::PointXYZRGB> cloud;
+              Utils::convertToPCL(pointCloud, cloud, Utils::CloudLayout::organized);
+              pcl::io::savePCDFileBinaryCompressed("WriterComparison_pcl_compressed.pcd", cloud);
+          } },
+        { "Zivid::Frame::save PCD",
+          "WriterComparison_zivid.pcd",
+          [&frame]() { frame.save("WriterComparison_zivid.pcd"); } },
+        { "PCL convert + savePCDFileBinary, contrast",
+          "WriterComparison_pcl_contrast.pcd",
+          [&pointCloud]() {
+              pcl::PointCloud<PointXYZRGBContrast> cloud;
+              Utils::convertToPCL(pointCloud, cloud, Utils::CloudLayout::organized);
+              pcl::io::savePCDFileBinary("WriterComparison_pcl_contrast.pcd", cloud);
+          } },
+        { "Streaming PCD binary",
+          "WriterComparison_stream.pcd",
+          [&pointCloud]() {
+              writePCD(pointCloud, "WriterComparison_stream.pcd", PCDEncoding::binary, false, PointFields::xyzrgb);
+          } },
+        { "Streaming PCD binary, skip NaN",
+          "WriterComparison_stream_dense.pcd",
+          [&pointCloud]() {
+              writePCD(pointCloud, "WriterComparison_stream_dense.pcd", PCDEncoding::binary, true, PointFields::xyzrgb);
+          } },
+        { "Streaming PCD binary_compressed",
+          "WriterComparison_stream_compressed.pcd",
+          [&pointCloud]() {
+              writePCD(pointCloud,
+                       "WriterComparison_stream_compressed.pcd",
+                       PCDEncoding::binaryCompressed,
+                       false,
+                       PointFields::xyzrgb);
+          } },
+        { "Streaming PCD binary, contrast",
+          "WriterComparison_stream_contrast.pcd",
+          [&pointCloud]() {
+              writePCD(pointCloud,
+                       "WriterComparison_stream_contrast.pcd",
+                       PCDEncoding::binary,
+                       false,
+                       PointFields::xyzrgbContrast);
+          } },
+        { "Streaming PLY binary",
+          "WriterComparison_stream.ply",
+          [&pointCloud]() { writePLY(pointCloud, "WriterComparison_stream.ply", false); } }
+    };
+
+    std::cout << "Comparing writers, median of " << numRepetitions << " repetitions:" << std::endl;
+    std::cout << std::left << std::setw(44) << "Writer" << std::right << std::setw(13) << "Time" << std::setw(13)
+              << "Size" << std::setw(15) << "Rate" << std::endl;
+    for(const auto &writer : writers)
+    {
+        const double milliseconds = measureMedianMilliseconds(numRepetitions, writer.write);
+        std::ifstream file(writer.fileName, std::ios::binary | std::ios::ate);
+        const double megabytes = static_cast<double>(file.tellg()) / 1e6;
+        std::cout << std::left << std::setw(44) << writer.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << milliseconds << " ms" << std::setw(10) << megabytes << " MB" << std::setw(10)
+                  << megabytes / milliseconds * 1000.0 << " MB/s" << std::endl;
+    }
+}
+
+template<typename Function>
+double measureMedianMilliseconds(const size_t numRepetitions, Function function)
+{
+    std::vector<double> milliseconds;
+    for(size_t i = 0; i < numRepetitions; i++)
+    {
+        const auto before = std::chrono::steady_clock::now();
+        function();
+        const auto after = std::chrono::steady_clock::now();
+        milliseconds.push_back(std::chrono::duration<double, std::milli>(after - before).count());
+    }
+    std::sort(milliseconds.begin(), milliseconds.end());
+    return milliseconds.at(milliseconds.size() / 2);
+}
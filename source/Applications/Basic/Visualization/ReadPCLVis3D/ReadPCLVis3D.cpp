@@ -2,42 +2,273 @@
 This example shows how to read a PCL point cloud and visualize it. To get a
 Zivid point cloud in .PCD file format, run ZDF2PCD sample. Then, copy it to
 the correct directory for this sample.
+
+Binary .PCD files are memory mapped instead of parsed into a freshly allocated
+cloud. The points are read in place through a strided view, and copied into the
+pcl::PointCloud on all available cores. Run with --no-copy to only scan the
+mapped points, or with --pcl-loader to load through pcl::io::loadPCDFile, and
+compare the reported load throughput.
+
+The viewer waits for window events between frames instead of spinning, so it
+does not keep a CPU core busy while the window is open.
 */
 
 #include <Zivid/Zivid.h>
 
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
-#include <pcl/visualization/cloud_viewer.h>
+#include <pcl/visualization/pcl_visualizer.h>
+
+#include <ParallelRanges.h>
+#include <ViewerLoop.h>
 
+#include <clipp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define MAPPED_PCD_LOADER_SUPPORTED
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+enum class Loader
+{
+    mapped,
+    pcl
+};
+
+#ifdef MAPPED_PCD_LOADER_SUPPORTED
+/*
+Read-only memory mapping of a whole file. Mapping is cheap: the pages are read from disk, or from the page
+cache, when the points are first touched, so the cost of reading the file moves into the first pass over
+the points.
+*/
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &fileName)
+    {
+        const int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+        if(fileDescriptor < 0) throw std::runtime_error("Failed to open " + fileName);
+
+        struct stat status
+        {};
+        if(fstat(fileDescriptor, &status) != 0 || status.st_size == 0)
+        {
+            close(fileDescriptor);
+            throw std::runtime_error("Failed to get the size of " + fileName + ", or it is empty");
+        }
+        m_size = static_cast<size_t>(status.st_size);
+
+        // The mapping stays valid after the file descriptor is closed
+        void *address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        close(fileDescriptor);
+        if(address == MAP_FAILED) throw std::runtime_error("Failed to map " + fileName);
+        m_address = address;
+
+        // Every thread reads its range front to back, so let the kernel start reading the file right away
+        posix_madvise(m_address, m_size, POSIX_MADV_WILLNEED);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
 
-int main()
+    ~MappedFile()
+    {
+        munmap(m_address, m_size);
+    }
+
+    const char *data() const
+    {
+        return static_cast<const char *>(m_address);
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    void *m_address = nullptr;
+    size_t m_size = 0;
+};
+
+struct PCDField
+{
+    std::string name;
+    size_t size;
+    char type;
+    size_t count;
+    size_t offset;
+};
+
+struct PCDHeader
+{
+    std::vector<PCDField> fields;
+    size_t width = 0;
+    size_t height = 0;
+    size_t numPoints = 0;
+    size_t pointSize = 0;
+    size_t dataOffset = 0;
+    std::string encoding;
+};
+
+/*
+Zero-copy view of the points of a binary .PCD file. The points are records of stride bytes with every
+field at a fixed offset, so the view needs nothing but the start of the data, the stride and the field
+offsets. The records are in general not aligned, so the fields are read with memcpy, which compiles to
+plain loads.
+*/
+class PCDPointView
+{
+public:
+    PCDPointView(const char *data,
+                 const size_t numPoints,
+                 const size_t stride,
+                 const size_t xOffset,
+                 const size_t yOffset,
+                 const size_t zOffset,
+                 const size_t rgbOffset)
+        : m_data{ data }
+        , m_numPoints{ numPoints }
+        , m_stride{ stride }
+        , m_xOffset{ xOffset }
+        , m_yOffset{ yOffset }
+        , m_zOffset{ zOffset }
+        , m_rgbOffset{ rgbOffset }
+    {}
+
+    size_t size() const
+    {
+        return m_numPoints;
+    }
+
+    float x(const size_t index) const
+    {
+        return read<float>(index, m_xOffset);
+    }
+
+    float y(const size_t index) const
+    {
+        return read<float>(index, m_yOffset);
+    }
+
+    float z(const size_t index) const
+    {
+        return read<float>(index, m_zOffset);
+    }
+
+    uint32_t rgb(const size_t index) const
+    {
+        return read<uint32_t>(index, m_rgbOffset);
+    }
+
+private:
+    template<typename T>
+    T read(const size_t index, const size_t offset) const
+    {
+        T value;
+        std::memcpy(&value, m_data + index * m_stride + offset, sizeof(T));
+        return value;
+    }
+
+    const char *m_data;
+    size_t m_numPoints;
+    size_t m_stride;
+    size_t m_xOffset;
+    size_t m_yOffset;
+    size_t m_zOffset;
+    size_t m_rgbOffset;
+};
+
+bool loadMappedPCD(const std::string &, pcl::PointCloud<pcl::PointXYZRGB> &, bool);
+PCDHeader parsePCDHeader(const char *, size_t);
+PCDPointView makePointView(const char *, size_t, const PCDHeader &);
+const PCDField &findField(const PCDHeader &, const std::vector<std::string> &);
+void copyToPCL(const PCDPointView &, size_t, size_t, pcl::PointCloud<pcl::PointXYZRGB> &);
+size_t countValidPoints(const PCDPointView &);
+#endif
+size_t getFileSize(const std::string &);
+void printThroughput(const std::string &, size_t, std::chrono::steady_clock::duration);
+
+int main(int argc, char **argv)
 {
     try
     {
         std::string filenamePCD = "Zivid3D.pcd";
+        auto loader = Loader::mapped;
+        bool copyPoints = true;
+
+        auto cli = (clipp::opt_value("file", filenamePCD) % "The .PCD file to read (default Zivid3D.pcd)",
+                    clipp::option("--pcl-loader").set(loader, Loader::pcl) % "Load through pcl::io::loadPCDFile",
+                    clipp::option("--no-copy").set(copyPoints, false)
+                        % "Only scan the memory mapped points, without copying or showing them");
+        if(!parse(argc, argv, cli))
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            return EXIT_FAILURE;
+        }
+
         pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloudPTR(new pcl::PointCloud<pcl::PointXYZRGB>);
 
         // Reading a .PCL point cloud
-        if(pcl::io::loadPCDFile<pcl::PointXYZRGB>(filenamePCD, *cloudPTR) == -1) //* load the file
+#ifdef MAPPED_PCD_LOADER_SUPPORTED
+        if(loader == Loader::mapped && !loadMappedPCD(filenamePCD, *cloudPTR, copyPoints))
+        {
+            std::cout << filenamePCD << " is not a binary .PCD file, loading it through PCL instead" << std::endl;
+            loader = Loader::pcl;
+        }
+#else
+        if(loader == Loader::mapped)
+        {
+            std::cout << "Memory mapping is not supported on this platform, loading through PCL instead" << std::endl;
+            loader = Loader::pcl;
+        }
+#endif
+        if(loader == Loader::mapped && !copyPoints)
+        {
+            return 0;
+        }
+
+        if(loader == Loader::pcl)
         {
-            std::cerr
-                << "Error: "
-                << "Run ZDF2PCD sample to get a Zivid point cloud in .PCD file format, then copy it in the correct directory for this sample. \n"
-                << std::endl;
-            return (-1);
+            const auto beforeLoad = std::chrono::steady_clock::now();
+            if(pcl::io::loadPCDFile<pcl::PointXYZRGB>(filenamePCD, *cloudPTR) == -1) //* load the file
+            {
+                std::cerr
+                    << "Error: "
+                    << "Run ZDF2PCD sample to get a Zivid point cloud in .PCD file format, then copy it in the correct directory for this sample. \n"
+                    << std::endl;
+                return (-1);
+            }
+            printThroughput(
+                "Loaded through PCL", getFileSize(filenamePCD), std::chrono::steady_clock::now() - beforeLoad);
         }
         std::cout << "Loaded " << cloudPTR->width * cloudPTR->height << " data points from " + filenamePCD << std::endl;
 
         //Simple Cloud Visualization
-        pcl::visualization::CloudViewer viewer("Simple Cloud Viewer");
-        viewer.showCloud(cloudPTR);
+        pcl::visualization::PCLVisualizer viewer("Simple Cloud Viewer");
+        viewer.addPointCloud<pcl::PointXYZRGB>(
+            cloudPTR, pcl::visualization::PointCloudColorHandlerRGBField<pcl::PointXYZRGB>(cloudPTR), "cloud");
+        viewer.resetCamera();
         std::cout << "Press r to centre and zoom the viewer so that the entire cloud is visible" << std::endl;
         std::cout << "Press q to me exit the viewer application" << std::endl;
-        while(!viewer.wasStopped())
-        {
-        }
+        const double maxFramesPerSecond = 30.0;
+        Utils::runViewerLoop(viewer, maxFramesPerSecond, [] {});
 
         return 0;
     }
@@ -47,3 +278,225 @@ int main()
         return EXIT_FAILURE;
     }
 }
+
+#ifdef MAPPED_PCD_LOADER_SUPPORTED
+bool loadMappedPCD(const std::string &fileName, pcl::PointCloud<pcl::PointXYZRGB> &cloud, const bool copyPoints)
+{
+    /*
+	Maps the file and reads the points through a zero-copy view. With copyPoints the points are copied into
+	the cloud, otherwise they are only scanned once, which shows how fast the points can be consumed in
+	place. Returns false, without touching the cloud, if the file is not a binary .PCD file.
+	*/
+
+    const auto beforeMapping = std::chrono::steady_clock::now();
+    const MappedFile file(fileName);
+    const auto header = parsePCDHeader(file.data(), file.size());
+    if(header.encoding != "binary")
+    {
+        return false;
+    }
+    const auto view = makePointView(file.data(), file.size(), header);
+    const auto afterMapping = std::chrono::steady_clock::now();
+    std::cout << "Mapped " << fileName << " and parsed the header in "
+              << std::chrono::duration<double, std::milli>(afterMapping - beforeMapping).count() << " ms" << std::endl;
+
+    const size_t numDataBytes = view.size() * header.pointSize;
+    if(copyPoints)
+    {
+        copyToPCL(view, header.width, header.height, cloud);
+        printThroughput("Copied " + std::to_string(view.size()) + " points into the PCL cloud",
+                        numDataBytes,
+                        std::chrono::steady_clock::now() - afterMapping);
+    }
+    else
+    {
+        const auto numValid = countValidPoints(view);
+        printThroughput("Scanned " + std::to_string(view.size()) + " points in place ("
+                            + std::to_string(numValid) + " valid)",
+                        numDataBytes,
+                        std::chrono::steady_clock::now() - afterMapping);
+    }
+    printThroughput("Total load", file.size(), std::chrono::steady_clock::now() - beforeMapping);
+    return true;
+}
+
+PCDHeader parsePCDHeader(const char *data, const size_t size)
+{
+    /*
+	The header is a sequence of text lines, and the point data starts right after the DATA line.
+	*/
+
+    PCDHeader header;
+    std::vector<std::string> names;
+    std::vector<size_t> sizes;
+    std::vector<char> types;
+    std::vector<size_t> counts;
+
+    size_t position = 0;
+    while(position < size && header.encoding.empty())
+    {
+        const char *lineEnd = std::find(data + position, data + size, '\n');
+        const std::string line(data + position, lineEnd);
+        position = static_cast<size_t>(lineEnd - data) + 1;
+        if(line.empty() || line[0] == '#') continue;
+
+        std::istringstream lineStream(line);
+        std::string keyword;
+        lineStream >> keyword;
+        if(keyword == "FIELDS")
+        {
+            for(std::string name; lineStream >> name;) names.push_back(name);
+        }
+        else if(keyword == "SIZE")
+        {
+            for(size_t fieldSize; lineStream >> fieldSize;) sizes.push_back(fieldSize);
+        }
+        else if(keyword == "TYPE")
+        {
+            for(char type; lineStream >> type;) types.push_back(type);
+        }
+        else if(keyword == "COUNT")
+        {
+            for(size_t count; lineStream >> count;) counts.push_back(count);
+        }
+        else if(keyword == "WIDTH")
+        {
+            lineStream >> header.width;
+        }
+        else if(keyword == "HEIGHT")
+        {
+            lineStream >> header.height;
+        }
+        else if(keyword == "POINTS")
+        {
+            lineStream >> header.numPoints;
+        }
+        else if(keyword == "DATA")
+        {
+            lineStream >> header.encoding;
+            header.dataOffset = position;
+        }
+    }
+
+    if(header.encoding.empty()) throw std::runtime_error("The .PCD header has no DATA line");
+    if(counts.empty()) counts.assign(names.size(), 1);
+    if(names.empty() || sizes.size() != names.size() || types.size() != names.size()
+       || counts.size() != names.size())
+    {
+        throw std::runtime_error("The FIELDS, SIZE, TYPE and COUNT lines of the .PCD header do not match");
+    }
+
+    for(size_t i = 0; i < names.size(); ++i)
+    {
+        header.fields.push_back(PCDField{ names[i], sizes[i], types[i], counts[i], header.pointSize });
+        header.pointSize += sizes[i] * counts[i];
+    }
+    if(header.numPoints == 0) header.numPoints = header.width * header.height;
+
+    return header;
+}
+
+PCDPointView makePointView(const char *data, const size_t size, const PCDHeader &header)
+{
+    const auto &x = findField(header, { "x" });
+    const auto &y = findField(header, { "y" });
+    const auto &z = findField(header, { "z" });
+    const auto &rgb = findField(header, { "rgb", "rgba" });
+    for(const auto *field : { &x, &y, &z })
+    {
+        if(field->type != 'F' || field->size != sizeof(float))
+        {
+            throw std::runtime_error("The " + field->name + " field of the .PCD file is not a 32 bit float");
+        }
+    }
+    if(rgb.size != sizeof(uint32_t))
+    {
+        throw std::runtime_error("The " + rgb.name + " field of the .PCD file is not 32 bits");
+    }
+
+    if(size < header.dataOffset || (size - header.dataOffset) / header.pointSize < header.numPoints)
+    {
+        throw std::runtime_error("The .PCD file is shorter than its header says");
+    }
+
+    return PCDPointView(
+        data + header.dataOffset, header.numPoints, header.pointSize, x.offset, y.offset, z.offset, rgb.offset);
+}
+
+const PCDField &findField(const PCDHeader &header, const std::vector<std::string> &names)
+{
+    for(const auto &field : header.fields)
+    {
+        if(std::find(names.begin(), names.end(), field.name) != names.end())
+        {
+            return field;
+        }
+    }
+    throw std::runtime_error("The .PCD file has no " + names.front() + " field");
+}
+
+void copyToPCL(const PCDPointView &view,
+               const size_t width,
+               const size_t height,
+               pcl::PointCloud<pcl::PointXYZRGB> &cloud)
+{
+    /*
+	Every thread copies one contiguous range of points, so the mapped pages are read in parallel as well.
+	Clouds whose WIDTH and HEIGHT do not match POINTS are loaded as unorganized.
+	*/
+
+    const bool organized = width * height == view.size();
+    cloud.width = static_cast<uint32_t>(organized ? width : view.size());
+    cloud.height = static_cast<uint32_t>(organized ? height : 1);
+    cloud.is_dense = false;
+    cloud.points.resize(view.size());
+
+    pcl::PointXYZRGB *destination = cloud.points.data();
+    const auto copyRange = [&view, destination](size_t, const size_t begin, const size_t end) {
+        for(size_t i = begin; i < end; ++i)
+        {
+            const auto rgb = view.rgb(i);
+            const auto red = static_cast<uint8_t>((rgb >> 16U) & 0xFFU);
+            const auto green = static_cast<uint8_t>((rgb >> 8U) & 0xFFU);
+            const auto blue = static_cast<uint8_t>(rgb & 0xFFU);
+            destination[i].x = view.x(i); // NOLINT(cppcoreguidelines-pro-type-union-access)
+            destination[i].y = view.y(i); // NOLINT(cppcoreguidelines-pro-type-union-access)
+            destination[i].z = view.z(i); // NOLINT(cppcoreguidelines-pro-type-union-access)
+            destination[i].r = red;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+            destination[i].g = green;     // NOLINT(cppcoreguidelines-pro-type-union-access)
+            destination[i].b = blue;      // NOLINT(cppcoreguidelines-pro-type-union-access)
+        }
+    };
+    Utils::forEachRange(view.size(), Utils::computeNumRanges(view.size()), copyRange);
+}
+
+size_t countValidPoints(const PCDPointView &view)
+{
+    const size_t numRanges = Utils::computeNumRanges(view.size());
+    std::vector<size_t> numValidPerRange(numRanges, 0);
+    const auto countRange = [&view, &numValidPerRange](const size_t range, const size_t begin, const size_t end) {
+        size_t numValid = 0;
+        for(size_t i = begin; i < end; ++i)
+        {
+            if(!std::isnan(view.z(i))) ++numValid;
+        }
+        numValidPerRange.at(range) = numValid;
+    };
+    Utils::forEachRange(view.size(), numRanges, countRange);
+    return std::accumulate(numValidPerRange.begin(), numValidPerRange.end(), size_t{ 0 });
+}
+#endif
+
+size_t getFileSize(const std::string &fileName)
+{
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+}
+
+void printThroughput(const std::string &step, const size_t numBytes, const std::chrono::steady_clock::duration duration)
+{
+    const auto milliseconds = std::chrono::duration<double, std::milli>(duration).count();
+    const auto megabytes = static_cast<double>(numBytes) / 1e6;
+    std::cout << step << ": " << milliseconds << " ms, " << megabytes << " MB, "
+              << (milliseconds > 0.0 ? megabytes / (milliseconds / 1000.0) : 0.0) << " MB/s" << std::endl;
+}
@@ -1,6 +1,17 @@
+/*
+This example shows how to acquire HDR images from the Zivid camera.
+
+The source frames and the HDR frame are saved by a background writer, so each
+frame is written to disk while the next one is captured and combined.
+*/
+
 #include <Zivid/Zivid.h>
 
+#include <BackgroundWriter.h>
+
+#include <future>
 #include <iostream>
+#include <string>
 
 int main()
 {
@@ -11,6 +22,9 @@ int main()
         std::cout << "Connecting to camera" << std::endl;
         auto camera = zivid.connectCamera();
 
+        Utils::BackgroundWriter writer(1, 4, Utils::BackgroundWriter::OverflowPolicy::block);
+        std::vector<std::future<void>> saves;
+
         std::cout << "Recording HDR source images" << std::endl;
         std::vector<Zivid::Frame> frames;
         for(const size_t iris : { 20U, 25U, 30U })
@@ -18,16 +32,24 @@ int main()
             std::cout << "Capture frame with iris = " << iris << std::endl;
             camera << Zivid::Settings::Iris{ iris };
             frames.emplace_back(camera.capture());
+
+            const auto frame = frames.back();
+            const auto fileName = std::to_string(iris) + ".zdf";
+            std::cout << "Saving the frame to " << fileName << " in the background" << std::endl;
+            saves.emplace_back(writer.submit([frame, fileName]() { frame.save(fileName); }));
         }
 
         std::cout << "Creating HDR frame" << std::endl;
-        auto hdrFrame = Zivid::HDR::combineFrames(begin(frames), end(frames));
+        const auto hdrFrame = Zivid::HDR::combineFrames(begin(frames), end(frames));
+
+        std::cout << "Saving the HDR frame to HDR.zdf in the background" << std::endl;
+        saves.emplace_back(writer.submit([hdrFrame]() { hdrFrame.save("HDR.zdf"); }));
 
-        std::cout << "Saving the frames" << std::endl;
-        frames[0].save("20.zdf");
-        frames[1].save("25.zdf");
-        frames[2].save("30.zdf");
-        hdrFrame.save("HDR.zdf");
+        std::cout << "Waiting for the frames to be saved" << std::endl;
+        for(auto &save : saves)
+        {
+            save.get();
+        }
     }
     catch(const std::exception &e)
     {
@@ -1,21 +1,56 @@
 /*
 This example shows how to acquire HDR images from the Zivid camera in a loop,
 with settings from .yml files.
+
+The HDR frames are saved by a background writer, so the next HDR capture starts
+as soon as the previous one is done instead of waiting for the disk. The number
+of writer threads and queued frames can be set on the command line, together
+with what to do when the queue is full: wait for a free slot (default), or drop
+the new frame so that the capture cadence is kept.
 */
 
 #include <Zivid/Zivid.h>
 
+#include <BackgroundWriter.h>
+
+#include <clipp.h>
+
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
-int main()
+int main(int argc, char **argv)
 {
     try
     {
+        size_t numWriters = 1;
+        size_t maxQueuedFrames = 2;
+        auto overflowPolicy = Utils::BackgroundWriter::OverflowPolicy::block;
+
+        auto cli = ((clipp::option("--writers") & clipp::value("count", numWriters)) % "Number of writer threads",
+                    (clipp::option("--queue") & clipp::value("count", maxQueuedFrames))
+                        % "Number of frames that may wait to be saved",
+                    clipp::option("--drop-when-full")
+                            .set(overflowPolicy, Utils::BackgroundWriter::OverflowPolicy::dropNewest)
+                        % "Drop new frames instead of waiting when the queue is full");
+        if(!parse(argc, argv, cli))
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            return EXIT_FAILURE;
+        }
+
         Zivid::Application zivid;
 
         std::cout << "Connecting to the camera" << std::endl;
         auto camera = zivid.connectCamera();
 
+        Utils::BackgroundWriter writer(numWriters, maxQueuedFrames, overflowPolicy);
+        std::vector<std::string> hdrPaths;
+        std::vector<std::future<void>> saves;
+
         const size_t captures = 3;
         const size_t framesPerCapture = 3;
         for(size_t set = 1; set <= captures; set++)
@@ -33,12 +68,39 @@ int main()
                 settingsVector.emplace_back(setting);
             }
 
+            const auto beforeCapture = std::chrono::steady_clock::now();
             const auto hdrFrame = Zivid::HDR::capture(camera, settingsVector);
+            const auto afterCapture = std::chrono::steady_clock::now();
 
             std::stringstream hdrPath;
             hdrPath << "HDR_" << set << ".zdf";
-            std::cout << "Saving the HDR to " << hdrPath.str() << std::endl;
-            hdrFrame.save(hdrPath.str());
+            std::cout << "Captured the HDR in "
+                      << std::chrono::duration<double, std::milli>(afterCapture - beforeCapture).count()
+                      << " ms, saving it to " << hdrPath.str() << " in the background" << std::endl;
+            const auto path = hdrPath.str();
+            hdrPaths.emplace_back(path);
+            saves.emplace_back(writer.submit([hdrFrame, path]() { hdrFrame.save(path); }));
+        }
+
+        std::cout << "Waiting for the HDR frames to be saved" << std::endl;
+        size_t numFailed = 0;
+        for(size_t i = 0; i < saves.size(); ++i)
+        {
+            try
+            {
+                saves[i].get();
+            }
+            catch(const std::exception &e)
+            {
+                std::cerr << "Could not save " << hdrPaths[i] << ": " << Zivid::toString(e) << std::endl;
+                ++numFailed;
+            }
+        }
+        std::cout << "Saved " << saves.size() - numFailed << " of " << saves.size() << " HDR frames ("
+                  << writer.numDropped() << " dropped because the queue was full)" << std::endl;
+        if(numFailed > 0)
+        {
+            return EXIT_FAILURE;
         }
     }
     catch(const std::exception &e)
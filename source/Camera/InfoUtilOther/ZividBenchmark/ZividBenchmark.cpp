@@ -1,6 +1,119 @@
 #include <Zivid/Zivid.h>
+
+#ifdef BENCHMARK_WITH_EIGEN3
+#    include <Eigen/Core>
+#    include <Eigen/Geometry>
+#endif
+
+#ifdef BENCHMARK_WITH_OPENCV
+#    include <opencv2/core/core.hpp>
+#    include <opencv2/imgproc/imgproc.hpp>
+#endif
+
+#ifdef BENCHMARK_WITH_PCL
+#    include <pcl/point_cloud.h>
+#    include <pcl/point_types.h>
+
+#    include <PCLConversion.h>
+#endif
+
+#include <clipp.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+namespace
+{
+    std::atomic<size_t> allocationCount{ 0 };
+    std::atomic<size_t> allocatedBytes{ 0 };
+
+    void *countedAllocation(const size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+// GCC pairs the inlined free() with the operator new at the call site and warns, although both are replaced here
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+    void countedDeallocation(void *pointer) noexcept
+    {
+        std::free(pointer);
+    }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#    pragma GCC diagnostic pop
+#endif
+} // namespace
+
+// Replacing the global allocation functions counts every operator new in the process, including those in the Zivid
+// libraries when they share the C++ runtime with this executable. Plain malloc calls are not counted.
+void *operator new(size_t size)
+{
+    if(auto *pointer = countedAllocation(size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocation(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocation(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    countedDeallocation(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    countedDeallocation(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    countedDeallocation(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    countedDeallocation(pointer);
+}
 
 namespace
 {
@@ -9,6 +122,180 @@ namespace
     using HighResClock = std::chrono::high_resolution_clock;
     using Duration = std::chrono::nanoseconds;
 
+    struct Measurement
+    {
+        Measurement() = default;
+
+        Measurement(std::string sectionName,
+                    std::string measurementName,
+                    std::vector<Duration> durations,
+                    const size_t pointsPerIteration = 0,
+                    const size_t bytesPerIteration = 0)
+            : section{ std::move(sectionName) }
+            , name{ std::move(measurementName) }
+            , samples{ std::move(durations) }
+            , numPoints{ pointsPerIteration }
+            , numBytes{ bytesPerIteration }
+        {}
+
+        std::string section;
+        std::string name;
+        std::vector<Duration> samples;
+        size_t numPoints = 0; // Points processed per iteration, zero if not a point cloud operation
+        size_t numBytes = 0;  // Bytes written or read per iteration, zero if not a file operation
+    };
+
+    struct MemoryUsage
+    {
+        bool hasResidentSetSize;
+        size_t peakResidentSetSizeIncreaseKiB;
+        size_t numAllocations;
+        size_t allocatedBytes;
+        bool hasPageFaults;
+        size_t minorPageFaults;
+        size_t majorPageFaults;
+    };
+
+    struct SectionMemoryUsage
+    {
+        std::string section;
+        MemoryUsage usage;
+    };
+
+    struct TraceEvent
+    {
+        std::string name;
+        const char *category;
+        std::string section;
+        HighResClock::time_point begin;
+        HighResClock::time_point end;
+        size_t threadId;
+    };
+
+    // Begin and end of every timed call, for inspecting stalls on a timeline. Disabled by default, in which case
+    // record() is a single branch and does not allocate, so the timings and memory figures are unaffected. It takes
+    // plain C strings, so that no std::string is built for the arguments before the branch.
+    class TraceRecorder
+    {
+    public:
+        void enable()
+        {
+            m_enabled = true;
+            m_start = HighResClock::now();
+            m_events.reserve(4096);
+        }
+
+        void record(const char *name,
+                    const char *category,
+                    const char *section,
+                    const HighResClock::time_point &begin,
+                    const HighResClock::time_point &end,
+                    const size_t threadId = 1)
+        {
+            if(!m_enabled) return;
+            m_events.push_back({ name, category, section, begin, end, threadId });
+        }
+
+        const std::vector<TraceEvent> &events() const
+        {
+            return m_events;
+        }
+
+        HighResClock::time_point start() const
+        {
+            return m_start;
+        }
+
+    private:
+        bool m_enabled = false;
+        HighResClock::time_point m_start;
+        std::vector<TraceEvent> m_events;
+    };
+
+    // Duration in milliseconds of an operation modelled as a fixed overhead plus a cost per HDR frame
+    struct CostModel
+    {
+        std::string name;
+        double fixedMilliseconds;
+        double perFrameMilliseconds;
+        double rSquared;
+    };
+
+    struct BenchmarkResults
+    {
+        std::vector<Measurement> measurements;
+        std::vector<SectionMemoryUsage> memoryUsages;
+        std::vector<CostModel> costModels;
+        TraceRecorder trace;
+    };
+
+    struct Statistics
+    {
+        double min;
+        double max;
+        double mean;
+        double stddev;
+        double p50;
+        double p90;
+        double p99;
+        double p999;
+    };
+
+    struct ResultLine
+    {
+        std::string name;
+        Duration median;
+        Duration mean;
+    };
+
+    struct HDRSet
+    {
+        std::vector<unsigned int> irises;
+        std::vector<size_t> exposureTimes;
+    };
+
+    std::vector<std::string> defaultSections()
+    {
+        return { "connect", "assisted", "capture3d", "filters", "capture2d", "save", "postprocessing" };
+    }
+
+    // Sections that take long are only run when selected with --sections
+    std::vector<std::string> allSections()
+    {
+        auto sections = defaultSections();
+        sections.emplace_back("hdrsweep");
+        sections.emplace_back("scaling");
+        return sections;
+    }
+
+    struct BenchmarkOptions
+    {
+        std::vector<std::string> sections{ defaultSections() };
+        size_t numConnects = 10;
+        size_t numFrames3D = 20;
+        size_t numFrames2D = 50;
+        size_t numFramesSave = 10;
+        size_t numConversions = 20;
+        size_t numWarmups = 5;
+        size_t maxSweepFrames = 10;
+        size_t maxThreads = 0; // Zero means std::thread::hardware_concurrency()
+        bool syncSaves = false;     // Include fsync in the save time
+        bool coldPageCache = false; // Evict the file from the page cache before every load
+        Duration timeBudget{ 0 }; // Per measurement loop, zero means no limit
+        std::vector<HDRSet> hdrSets;
+        std::string scalingFileName; // ZDF processed by the scaling section
+    };
+
+    struct SystemInfo
+    {
+        std::string api;
+        std::string os;
+        std::string camera;
+        std::string computeDevice;
+        std::string fileCamera;
+        std::string date;
+    };
+
     Duration computeAverageDuration(const std::vector<Duration> &durations)
     {
         return std::accumulate(durations.begin(), durations.end(), Duration{ 0 }) / durations.size();
@@ -25,6 +312,47 @@ namespace
         return durations.at(durations.size() / 2);
     }
 
+    double toMilliseconds(const Duration &duration)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+    }
+
+    double computePercentile(const std::vector<double> &sortedValues, const double percentile)
+    {
+        // Linear interpolation between the closest ranks
+        const double rank = percentile / 100.0 * static_cast<double>(sortedValues.size() - 1);
+        const auto lower = static_cast<size_t>(std::floor(rank));
+        const auto upper = std::min(lower + 1, sortedValues.size() - 1);
+        const double fraction = rank - static_cast<double>(lower);
+        return sortedValues.at(lower) + fraction * (sortedValues.at(upper) - sortedValues.at(lower));
+    }
+
+    Statistics computeStatistics(const std::vector<Duration> &durations)
+    {
+        if(durations.empty()) throw std::invalid_argument("Cannot compute statistics without samples");
+
+        std::vector<double> values(durations.size());
+        std::transform(durations.begin(), durations.end(), values.begin(), toMilliseconds);
+        std::sort(values.begin(), values.end());
+
+        const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        double sumOfSquares = 0.0;
+        for(const auto value : values)
+        {
+            sumOfSquares += (value - mean) * (value - mean);
+        }
+        const double variance = values.size() > 1 ? sumOfSquares / static_cast<double>(values.size() - 1) : 0.0;
+
+        return { values.front(),
+                 values.back(),
+                 mean,
+                 std::sqrt(variance),
+                 computePercentile(values, 50.0),
+                 computePercentile(values, 90.0),
+                 computePercentile(values, 99.0),
+                 computePercentile(values, 99.9) };
+    }
+
     template<typename T>
     std::string valueToStringWithPrecision(const T &value, const size_t precision)
     {
@@ -35,9 +363,15 @@ namespace
 
     std::string formatDuration(const Duration &duration)
     {
-        return valueToStringWithPrecision(
-                   std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count(), 3)
-               + " ms";
+        return valueToStringWithPrecision(toMilliseconds(duration), 3) + " ms";
+    }
+
+    template<typename T>
+    std::string streamToString(const T &value)
+    {
+        std::ostringstream ss;
+        ss << value;
+        return ss.str();
     }
 
     template<typename Target>
@@ -141,9 +475,11 @@ namespace
         std::cout << "  exposure time = { " << settings.exposureTime().toString() << " }" << std::endl;
     }
 
-    void printSaveHeader(const size_t numFrames)
+    void printSaveHeader(const size_t numFrames, const bool syncSaves, const bool coldPageCache)
     {
-        printHeaderLine(numFrames, { "Saving point cloud ", " times each (be patient):" });
+        printHeaderLine(numFrames, { "Saving and loading point cloud ", " times each (be patient):" });
+        std::cout << "  save = " << (syncSaves ? "synced to disk" : "to page cache") << std::endl;
+        std::cout << "  load = " << (coldPageCache ? "cold page cache" : "warm page cache") << std::endl;
     }
 
     void printResultLine(const std::string &name, const Duration &durationMedian, const Duration &durationMean)
@@ -151,30 +487,161 @@ namespace
         printFormated({ name, formatDuration(durationMedian), formatDuration(durationMean) });
     }
 
-    void printResults(const std::vector<std::string> &names, const std::vector<Duration> &durations)
+    void printResults(const std::vector<ResultLine> &resultLines)
     {
         printSecondarySeparationLine();
         printFormated({ "  Time:", "Median", "Mean" });
-        for(size_t i = 0; i < names.size(); i++)
+        for(const auto &resultLine : resultLines)
+        {
+            printResultLine(resultLine.name, resultLine.median, resultLine.mean);
+        }
+    }
+
+    // Returns the value of a "<field>: <value> kB" line in /proc/self/status, or zero where it does not exist
+    size_t readProcessStatusKiB(const std::string &field)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if(line.compare(0, field.size() + 1, field + ":") == 0)
+            {
+                return std::stoul(line.substr(field.size() + 1));
+            }
+        }
+        return 0;
+    }
+
+    // Process memory counters at the start of a section
+    class MemoryProbe
+    {
+    public:
+        MemoryProbe()
+        {
+            // Resets the peak resident set size to the current one (Linux 4.0 and newer). If this is not
+            // permitted, the reported increase is the increase of the peak since the process started.
+            std::ofstream("/proc/self/clear_refs") << "5";
+            m_peakResidentSetSizeKiB = readProcessStatusKiB("VmHWM");
+            m_numAllocations = allocationCount.load(std::memory_order_relaxed);
+            m_allocatedBytes = allocatedBytes.load(std::memory_order_relaxed);
+            readPageFaults(m_minorPageFaults, m_majorPageFaults);
+        }
+
+        MemoryUsage usage() const
+        {
+            const auto peakResidentSetSizeKiB = readProcessStatusKiB("VmHWM");
+            size_t minorPageFaults = 0;
+            size_t majorPageFaults = 0;
+            const bool hasPageFaults = readPageFaults(minorPageFaults, majorPageFaults);
+            return { peakResidentSetSizeKiB > 0,
+                     peakResidentSetSizeKiB - std::min(peakResidentSetSizeKiB, m_peakResidentSetSizeKiB),
+                     allocationCount.load(std::memory_order_relaxed) - m_numAllocations,
+                     allocatedBytes.load(std::memory_order_relaxed) - m_allocatedBytes,
+                     hasPageFaults,
+                     minorPageFaults - m_minorPageFaults,
+                     majorPageFaults - m_majorPageFaults };
+        }
+
+    private:
+        static bool readPageFaults(size_t &minorPageFaults, size_t &majorPageFaults)
         {
-            printResultLine(names.at(i), durations.at(i + i), durations.at(i + i + 1));
+#if defined(__unix__) || defined(__APPLE__)
+            rusage usage{};
+            if(getrusage(RUSAGE_SELF, &usage) == 0)
+            {
+                minorPageFaults = static_cast<size_t>(usage.ru_minflt);
+                majorPageFaults = static_cast<size_t>(usage.ru_majflt);
+                return true;
+            }
+#endif
+            minorPageFaults = 0;
+            majorPageFaults = 0;
+            return false;
         }
+
+        size_t m_peakResidentSetSizeKiB = 0;
+        size_t m_numAllocations = 0;
+        size_t m_allocatedBytes = 0;
+        size_t m_minorPageFaults = 0;
+        size_t m_majorPageFaults = 0;
+    };
+
+    std::string formatBytes(const double bytes)
+    {
+        return valueToStringWithPrecision(bytes / (1024.0 * 1024.0), 1) + " MiB";
+    }
+
+    void printMemoryUsage(const MemoryUsage &usage)
+    {
+        const std::string notAvailable = "n/a";
+        printSecondarySeparationLine();
+        printFormated({ "  Memory:", "", "" });
+        printFormated({ "  Peak RSS increase:",
+                        usage.hasResidentSetSize ? formatBytes(usage.peakResidentSetSizeIncreaseKiB * 1024.0)
+                                                 : notAvailable,
+                        "" });
+        printFormated({ "  Heap allocations:",
+                        std::to_string(usage.numAllocations),
+                        formatBytes(static_cast<double>(usage.allocatedBytes)) });
+        printFormated({ "  Page faults (minor, major):",
+                        usage.hasPageFaults ? std::to_string(usage.minorPageFaults) : notAvailable,
+                        usage.hasPageFaults ? std::to_string(usage.majorPageFaults) : notAvailable });
     }
 
-    void printConnectResults(const std::vector<Duration> &durations)
+    // Million points per second at the median duration
+    double computeThroughput(const Measurement &measurement)
     {
-        printResults({ "  Connect:", "  Disconnect:" }, durations);
+        const auto median = toMilliseconds(computeMedianDuration(measurement.samples));
+        return median > 0.0 ? static_cast<double>(measurement.numPoints) / median / 1000.0 : 0.0;
     }
 
-    void printCapture3DResults(const std::vector<Duration> &durations)
+    // Megabytes (10^6 bytes) per second at the median duration
+    double computeDataRate(const Measurement &measurement)
     {
-        printResults({ "  3D image acquisition time:", "  Point cloud processing time:", "  Total 3D capture time:" },
-                     durations);
+        const auto median = toMilliseconds(computeMedianDuration(measurement.samples));
+        return median > 0.0 ? static_cast<double>(measurement.numBytes) / median / 1000.0 : 0.0;
     }
 
-    void printAssistedCapture3DResults(const std::vector<Duration> &durations)
+    void reportResults(const std::vector<Measurement> &measurements,
+                       const MemoryProbe &memoryProbe,
+                       BenchmarkResults &results)
     {
-        printResults({ "  Suggest settings time:" }, durations);
+        const auto memoryUsage = memoryProbe.usage();
+        std::vector<ResultLine> resultLines;
+        for(const auto &measurement : measurements)
+        {
+            resultLines.push_back({ "  " + measurement.name + ":",
+                                    computeMedianDuration(measurement.samples),
+                                    computeAverageDuration(measurement.samples) });
+        }
+        printResults(resultLines);
+
+        if(std::any_of(measurements.begin(), measurements.end(), [](const Measurement &measurement) {
+               return measurement.numPoints > 0 || measurement.numBytes > 0;
+           }))
+        {
+            printSecondarySeparationLine();
+            printFormated({ "  Throughput:", "Median", "" });
+            for(const auto &measurement : measurements)
+            {
+                if(measurement.numPoints > 0)
+                {
+                    printFormated({ "  " + measurement.name + ":",
+                                    valueToStringWithPrecision(computeThroughput(measurement), 1),
+                                    "Mpoints/s" });
+                }
+                if(measurement.numBytes > 0)
+                {
+                    printFormated({ "  " + measurement.name + ":",
+                                    valueToStringWithPrecision(computeDataRate(measurement), 1),
+                                    "MB/s" });
+                }
+            }
+        }
+        printMemoryUsage(memoryUsage);
+
+        results.measurements.insert(results.measurements.end(), measurements.begin(), measurements.end());
+        results.memoryUsages.push_back({ measurements.front().section, memoryUsage });
     }
 
     void printNegligableFilters()
@@ -185,31 +652,40 @@ namespace
         printFormated({ "  Saturated", negligable, negligable });
     }
 
-    void printFilterResults(const std::vector<Duration> &durations)
+    void printFilterResults(const std::vector<ResultLine> &resultLines)
     {
         printPrimarySeparationLine();
         std::cout << "Filter processing time:" << std::endl;
-        printResults({ "  Gaussian:", "  Reflection:", "  Gaussian and Reflection:" }, durations);
+        printResults(resultLines);
         printSecondarySeparationLine();
         printNegligableFilters();
     }
 
-    void printCapture2DResults(const std::vector<Duration> &durations)
+    std::string currentUtcTime()
     {
-        printResults({ "  Total 2D capture time:" }, durations);
+        const auto now = std::time(nullptr);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return buffer;
     }
 
-    void printSaveResults(const std::vector<Duration> &durations)
+    SystemInfo makeSystemInfo(Zivid::Camera &camera, const std::string &fileCameraName)
     {
-        printResults({ "  Save ZDF:", "  Save PLY:", "  Save PCD:", "  Save XYZ:" }, durations);
+        return { Zivid::Version::libraryVersion(),
+                 OS_NAME,
+                 streamToString(camera),
+                 streamToString(camera.computeDevice()),
+                 fileCameraName,
+                 currentUtcTime() };
     }
 
-    void printZividInfo(Zivid::Camera camera)
+    void printZividInfo(const SystemInfo &systemInfo)
     {
-        std::cout << "API: " << Zivid::Version::libraryVersion() << std::endl;
-        std::cout << "OS: " << OS_NAME << std::endl;
-        std::cout << "Camera: " << camera << std::endl;
-        std::cout << "Compute device: " << camera.computeDevice() << std::endl;
+        std::cout << "API: " << systemInfo.api << std::endl;
+        std::cout << "OS: " << systemInfo.os << std::endl;
+        std::cout << "Camera: " << systemInfo.camera << std::endl;
+        if(!systemInfo.fileCamera.empty()) std::cout << "File camera: " << systemInfo.fileCamera << std::endl;
+        std::cout << "Compute device: " << systemInfo.computeDevice << std::endl;
         printPrimarySeparationLine();
         printCentered("Starting Zivid Benchmark");
     }
@@ -218,180 +694,947 @@ namespace
     {
         const auto cameras = zivid.cameras();
         if(cameras.size() != 1) throw std::runtime_error("At least one camera needs to be connected");
-        printZividInfo(cameras.at(0));
         return cameras.at(0);
     }
 
-    size_t getMinExposureTime(const std::string &modelName)
+    void printSkippedSection(const std::string &section)
     {
-        if(modelName.substr(0, 14) == "Zivid One Plus")
-        {
-            return 6500; // Min for Zivid One Plus
-        }
-
-        return 8333; // Min for Zivid One
+        printPrimarySeparationLine();
+        std::cout << "Skipping " << section << " (requires a physical camera)" << std::endl;
     }
 
-    std::vector<Zivid::Settings> makeSettingsVector(const std::vector<unsigned int> &irises,
-                                                    const std::vector<size_t> &exposureTimes,
-                                                    const bool enableGaussian,
-                                                    const bool enableReflection)
+    std::string escapeJson(const std::string &text)
     {
-        std::vector<Zivid::Settings> settingsVector(irises.size());
-
-        Zivid::Settings::Filters filters;
-        filters.set(Zivid::Settings::Filters::Contrast::Enabled{ true });
-        filters.set(Zivid::Settings::Filters::Outlier::Enabled{ true });
-        filters.set(Zivid::Settings::Filters::Saturated::Enabled{ true });
-        filters.set(Zivid::Settings::Filters::Gaussian::Enabled{ enableGaussian });
-        filters.set(Zivid::Settings::Filters::Reflection::Enabled{ enableReflection });
-
-        Zivid::Settings settings;
-        for(size_t i = 0; i < irises.size(); ++i)
+        std::string escaped;
+        for(const char character : text)
         {
-            settings.set(Zivid::Settings::Iris{ irises.at(i) });
-            settings.set(Zivid::Settings::Filters{ filters });
-            settings.set(Zivid::Settings::ExposureTime{ std::chrono::microseconds{ exposureTimes.at(i) } });
-            settingsVector.at(i) = settings;
+            switch(character)
+            {
+                case '"': escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\r': escaped += "\\r"; break;
+                case '\t': escaped += "\\t"; break;
+                default:
+                    if(static_cast<unsigned char>(character) < 0x20)
+                    {
+                        std::ostringstream ss;
+                        ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character);
+                        escaped += ss.str();
+                    }
+                    else
+                    {
+                        escaped += character;
+                    }
+            }
         }
-        return settingsVector;
+        return escaped;
     }
 
-    void benchmarkConnect(Zivid::Camera &camera, const size_t numConnects)
+    std::string quoteCsv(const std::string &text)
     {
-        printConnectHeader(numConnects);
-
-        std::vector<Duration> connectDurations;
-        std::vector<Duration> disconnectDurations;
-        std::vector<Duration> allDurations;
-
-        for(size_t i = 0; i < numConnects; i++)
+        std::string quoted = "\"";
+        for(const char character : text)
         {
-            const auto beforeConnect = HighResClock::now();
-            camera.connect();
-            const auto afterConnect = HighResClock::now();
-            camera.disconnect();
-            const auto afterDisconnect = HighResClock::now();
-
-            connectDurations.push_back(afterConnect - beforeConnect);
-            disconnectDurations.push_back(afterDisconnect - afterConnect);
+            quoted += character;
+            if(character == '"') quoted += '"';
         }
-
-        allDurations.push_back(computeMedianDuration(connectDurations));
-        allDurations.push_back(computeAverageDuration(connectDurations));
-        allDurations.push_back(computeMedianDuration(disconnectDurations));
-        allDurations.push_back(computeAverageDuration(disconnectDurations));
-
-        printConnectResults(allDurations);
+        return quoted + "\"";
     }
 
-    std::vector<Duration> benchmarkCapture3D(Zivid::Camera &camera,
-                                             const std::vector<Zivid::Settings> &settingsVector,
-                                             const size_t numFrames)
+    std::ofstream openOutputFile(const std::string &fileName)
     {
-        printCapture3DHeader(numFrames, settingsVector);
+        std::ofstream file(fileName);
+        if(!file) throw std::runtime_error("Failed to open " + fileName + " for writing");
+        file << std::fixed << std::setprecision(6);
+        return file;
+    }
 
-        for(size_t i = 0; i < 5; i++) // Warmup frames
+    // All durations in the output files are in milliseconds
+    void writeJsonResults(const std::string &fileName, const SystemInfo &systemInfo, const BenchmarkResults &results)
+    {
+        auto file = openOutputFile(fileName);
+        file << "{\n";
+        file << "  \"api\": \"" << escapeJson(systemInfo.api) << "\",\n";
+        file << "  \"os\": \"" << escapeJson(systemInfo.os) << "\",\n";
+        file << "  \"camera\": \"" << escapeJson(systemInfo.camera) << "\",\n";
+        file << "  \"computeDevice\": \"" << escapeJson(systemInfo.computeDevice) << "\",\n";
+        file << "  \"fileCamera\": \"" << escapeJson(systemInfo.fileCamera) << "\",\n";
+        file << "  \"date\": \"" << escapeJson(systemInfo.date) << "\",\n";
+        file << "  \"unit\": \"ms\",\n";
+        file << "  \"measurements\": [";
+        for(size_t i = 0; i < results.measurements.size(); i++)
         {
-            const auto frame = Zivid::HDR::capture(camera, settingsVector);
-            frame.getPointCloud();
+            const auto &measurement = results.measurements.at(i);
+            const auto statistics = computeStatistics(measurement.samples);
+            file << (i == 0 ? "\n" : ",\n") << "    {\n";
+            file << "      \"section\": \"" << escapeJson(measurement.section) << "\",\n";
+            file << "      \"name\": \"" << escapeJson(measurement.name) << "\",\n";
+            file << "      \"count\": " << measurement.samples.size() << ",\n";
+            file << "      \"min\": " << statistics.min << ",\n";
+            file << "      \"max\": " << statistics.max << ",\n";
+            file << "      \"mean\": " << statistics.mean << ",\n";
+            file << "      \"stddev\": " << statistics.stddev << ",\n";
+            file << "      \"p50\": " << statistics.p50 << ",\n";
+            file << "      \"p90\": " << statistics.p90 << ",\n";
+            file << "      \"p99\": " << statistics.p99 << ",\n";
+            file << "      \"p99.9\": " << statistics.p999 << ",\n";
+            if(measurement.numPoints > 0)
+            {
+                file << "      \"points\": " << measurement.numPoints << ",\n";
+                file << "      \"mpointsPerSecond\": " << computeThroughput(measurement) << ",\n";
+            }
+            if(measurement.numBytes > 0)
+            {
+                file << "      \"bytes\": " << measurement.numBytes << ",\n";
+                file << "      \"mbPerSecond\": " << computeDataRate(measurement) << ",\n";
+            }
+            file << "      \"samples\": [";
+            for(size_t j = 0; j < measurement.samples.size(); j++)
+            {
+                file << (j == 0 ? "" : ", ") << toMilliseconds(measurement.samples.at(j));
+            }
+            file << "]\n    }";
         }
-
-        std::vector<Duration> captureDurations;
-        std::vector<Duration> processDurations;
-        std::vector<Duration> totalDurations;
-        std::vector<Duration> allDurations;
-
-        for(size_t i = 0; i < numFrames; i++)
+        file << "\n  ],\n";
+        file << "  \"memory\": [";
+        for(size_t i = 0; i < results.memoryUsages.size(); i++)
         {
-            const auto beforeCapture = HighResClock::now();
-            const auto frame = Zivid::HDR::capture(camera, settingsVector);
-            const auto afterCapture = HighResClock::now();
-            frame.getPointCloud();
-            const auto afterProcess = HighResClock::now();
-
-            captureDurations.push_back(afterCapture - beforeCapture);
-            processDurations.push_back(afterProcess - afterCapture);
-            totalDurations.push_back(afterProcess - beforeCapture);
+            const auto &section = results.memoryUsages.at(i).section;
+            const auto &usage = results.memoryUsages.at(i).usage;
+            file << (i == 0 ? "\n" : ",\n") << "    {\n";
+            file << "      \"section\": \"" << escapeJson(section) << "\",\n";
+            file << "      \"peakRssIncreaseKiB\": "
+                 << (usage.hasResidentSetSize ? std::to_string(usage.peakResidentSetSizeIncreaseKiB) : "null")
+                 << ",\n";
+            file << "      \"allocations\": " << usage.numAllocations << ",\n";
+            file << "      \"allocatedBytes\": " << usage.allocatedBytes << ",\n";
+            file << "      \"minorPageFaults\": "
+                 << (usage.hasPageFaults ? std::to_string(usage.minorPageFaults) : "null") << ",\n";
+            file << "      \"majorPageFaults\": "
+                 << (usage.hasPageFaults ? std::to_string(usage.majorPageFaults) : "null") << "\n    }";
         }
-
-        allDurations.push_back(computeMedianDuration(captureDurations));
-        allDurations.push_back(computeAverageDuration(captureDurations));
-        allDurations.push_back(computeMedianDuration(processDurations));
-        allDurations.push_back(computeAverageDuration(processDurations));
-        allDurations.push_back(computeMedianDuration(totalDurations));
-        allDurations.push_back(computeAverageDuration(totalDurations));
-
-        printCapture3DResults(allDurations);
-
-        return totalDurations;
+        file << "\n  ],\n";
+        file << "  \"costModels\": [";
+        for(size_t i = 0; i < results.costModels.size(); i++)
+        {
+            const auto &costModel = results.costModels.at(i);
+            file << (i == 0 ? "\n" : ",\n") << "    {\n";
+            file << "      \"name\": \"" << escapeJson(costModel.name) << "\",\n";
+            file << "      \"fixed\": " << costModel.fixedMilliseconds << ",\n";
+            file << "      \"perFrame\": " << costModel.perFrameMilliseconds << ",\n";
+            file << "      \"rSquared\": " << costModel.rSquared << "\n    }";
+        }
+        file << "\n  ]\n}\n";
+        if(!file) throw std::runtime_error("Failed to write " + fileName);
     }
 
-    void benchmarkAssistedCapture3D(Zivid::Camera &camera, const size_t numFrames)
+    void writeCsvResults(const std::string &fileName, const BenchmarkResults &results)
     {
-        printAssistedCapture3DHeader(numFrames);
-
-        Zivid::CaptureAssistant::SuggestSettingsParameters suggestSettingsParameters(
-            std::chrono::milliseconds{ 1200 }, Zivid::CaptureAssistant::AmbientLightFrequency::none);
-
-        for(size_t i = 0; i < 5; i++) // Warmup
+        auto file = openOutputFile(fileName);
+        file << "section,name,count,min_ms,max_ms,mean_ms,stddev_ms,p50_ms,p90_ms,p99_ms,p99.9_ms,samples_ms,points,"
+                "mpoints_per_s,bytes,mb_per_s,peak_rss_increase_kib,allocations,allocated_bytes,minor_page_faults,"
+                "major_page_faults\n";
+        for(const auto &measurement : results.measurements)
         {
-            const auto settingsVector{ Zivid::CaptureAssistant::suggestSettings(camera, suggestSettingsParameters) };
+            const auto statistics = computeStatistics(measurement.samples);
+            file << quoteCsv(measurement.section) << "," << quoteCsv(measurement.name) << ","
+                 << measurement.samples.size() << "," << statistics.min << "," << statistics.max << ","
+                 << statistics.mean << "," << statistics.stddev << "," << statistics.p50 << "," << statistics.p90
+                 << "," << statistics.p99 << "," << statistics.p999 << ",\"";
+            for(size_t j = 0; j < measurement.samples.size(); j++)
+            {
+                file << (j == 0 ? "" : " ") << toMilliseconds(measurement.samples.at(j));
+            }
+            file << "\",";
+            if(measurement.numPoints > 0)
+            {
+                file << measurement.numPoints << "," << computeThroughput(measurement);
+            }
+            else
+            {
+                file << ",";
+            }
+            file << ",";
+            if(measurement.numBytes > 0)
+            {
+                file << measurement.numBytes << "," << computeDataRate(measurement);
+            }
+            else
+            {
+                file << ",";
+            }
+
+            // Memory figures are per section and repeated for each of its measurements
+            const auto sectionMemoryUsage =
+                std::find_if(results.memoryUsages.begin(),
+                             results.memoryUsages.end(),
+                             [&measurement](const SectionMemoryUsage &m) { return m.section == measurement.section; });
+            if(sectionMemoryUsage != results.memoryUsages.end())
+            {
+                const auto &usage = sectionMemoryUsage->usage;
+                file << "," << (usage.hasResidentSetSize ? std::to_string(usage.peakResidentSetSizeIncreaseKiB) : "")
+                     << "," << usage.numAllocations << "," << usage.allocatedBytes << ","
+                     << (usage.hasPageFaults ? std::to_string(usage.minorPageFaults) : "") << ","
+                     << (usage.hasPageFaults ? std::to_string(usage.majorPageFaults) : "");
+            }
+            else
+            {
+                file << ",,,,,";
+            }
+            file << "\n";
         }
+        if(!file) throw std::runtime_error("Failed to write " + fileName);
+    }
 
-        std::vector<Duration> suggestSettingsDurations;
+    double toMicroseconds(const Duration &duration)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(duration).count();
+    }
 
-        for(size_t i = 0; i < numFrames; i++)
+    // Chrome trace event format, which chrome://tracing and ui.perfetto.dev open directly
+    void writeTrace(const std::string &fileName, const TraceRecorder &trace)
+    {
+        auto file = openOutputFile(fileName);
+        file << std::setprecision(3);
+        file << "{\n";
+        file << "  \"displayTimeUnit\": \"ms\",\n";
+        file << "  \"traceEvents\": [\n";
+        file << "    { \"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, "
+                "\"args\": { \"name\": \"ZividBenchmark\" } }";
+        for(const auto &event : trace.events())
         {
-            const auto beforeSuggestSettings = HighResClock::now();
-            const auto settingsVector{ Zivid::CaptureAssistant::suggestSettings(camera, suggestSettingsParameters) };
-            const auto afterSuggestSettings = HighResClock::now();
-
-            suggestSettingsDurations.push_back(afterSuggestSettings - beforeSuggestSettings);
+            file << ",\n    { \"name\": \"" << escapeJson(event.name) << "\", \"cat\": \""
+                 << escapeJson(event.category) << "\", \"ph\": \"X\", \"ts\": "
+                 << toMicroseconds(event.begin - trace.start()) << ", \"dur\": "
+                 << toMicroseconds(event.end - event.begin) << ", \"pid\": 1, \"tid\": " << event.threadId << ", "
+                 << "\"args\": { \"section\": \"" << escapeJson(event.section) << "\" } }";
         }
-
-        std::vector<Duration> allDurations;
-        allDurations.push_back(computeMedianDuration(suggestSettingsDurations));
-        allDurations.push_back(computeAverageDuration(suggestSettingsDurations));
-
-        printAssistedCapture3DResults(allDurations);
+        file << "\n  ]\n}\n";
+        if(!file) throw std::runtime_error("Failed to write " + fileName);
     }
 
-    std::tuple<Duration, Duration> benchmarkFilterProcessing(const std::vector<Duration> &captureDuration,
-                                                             const std::vector<Duration> &captureDurationFilter)
+    struct SavedResults
     {
-        return std::make_tuple((computeMedianDuration(captureDurationFilter) - computeMedianDuration(captureDuration)),
-                               computeAverageDuration(captureDurationFilter) - computeAverageDuration(captureDuration));
-    }
+        SystemInfo systemInfo;
+        BenchmarkResults results;
+    };
 
-    void benchmarkCapture3DAndFilters(Zivid::Camera &camera,
-                                      const std::vector<unsigned int> &irises,
-                                      const std::vector<size_t> &exposureTimes,
-                                      const size_t numFrames3D)
+    // Reads back the JSON written by writeJsonResults
+    class JsonResultsReader
     {
-        const std::vector<Duration> captureDurationWithoutFilter =
-            benchmarkCapture3D(camera, makeSettingsVector(irises, exposureTimes, false, false), numFrames3D);
+    public:
+        explicit JsonResultsReader(std::string text)
+            : m_text{ std::move(text) }
+        {}
 
-        std::vector<bool> gaussian{ true, false, true };
-        std::vector<bool> reflection{ false, true, true };
+        SavedResults read()
+        {
+            SavedResults savedResults;
+            auto &systemInfo = savedResults.systemInfo;
+            const std::map<std::string, std::string *> stringFields{ { "api", &systemInfo.api },
+                                                                     { "os", &systemInfo.os },
+                                                                     { "camera", &systemInfo.camera },
+                                                                     { "computeDevice", &systemInfo.computeDevice },
+                                                                     { "fileCamera", &systemInfo.fileCamera },
+                                                                     { "date", &systemInfo.date } };
+            expect('{');
+            do
+            {
+                const auto key = readString();
+                expect(':');
+                const auto stringField = stringFields.find(key);
+                if(stringField != stringFields.end())
+                {
+                    *stringField->second = readString();
+                }
+                else if(key == "measurements")
+                {
+                    savedResults.results.measurements = readMeasurements();
+                }
+                else
+                {
+                    skipValue();
+                }
+            } while(tryConsume(','));
+            expect('}');
+            return savedResults;
+        }
 
-        std::vector<Duration> filterProcessingDurations;
-        for(size_t i = 0; i < gaussian.size(); i++)
+    private:
+        std::vector<Measurement> readMeasurements()
         {
-            const std::vector<Duration> captureDurationWithFilter =
-                benchmarkCapture3D(camera,
-                                   makeSettingsVector(irises, exposureTimes, gaussian.at(i), reflection.at(i)),
-                                   numFrames3D);
+            std::vector<Measurement> results;
+            expect('[');
+            if(tryConsume(']')) return results;
+            do
+            {
+                Measurement measurement;
+                expect('{');
+                do
+                {
+                    const auto key = readString();
+                    expect(':');
+                    if(key == "section")
+                    {
+                        measurement.section = readString();
+                    }
+                    else if(key == "name")
+                    {
+                        measurement.name = readString();
+                    }
+                    else if(key == "samples")
+                    {
+                        measurement.samples = readSamples();
+                    }
+                    else if(key == "points")
+                    {
+                        measurement.numPoints = static_cast<size_t>(readNumber());
+                    }
+                    else
+                    {
+                        skipValue();
+                    }
+                } while(tryConsume(','));
+                expect('}');
+                results.push_back(measurement);
+            } while(tryConsume(','));
+            expect(']');
+            return results;
+        }
 
-            const auto meanAndAverageFilterDurations =
-                benchmarkFilterProcessing(captureDurationWithoutFilter, captureDurationWithFilter);
+        std::vector<Duration> readSamples()
+        {
+            std::vector<Duration> samples;
+            expect('[');
+            if(tryConsume(']')) return samples;
+            do
+            {
+                samples.push_back(std::chrono::duration_cast<Duration>(
+                    std::chrono::duration<double, std::milli>{ readNumber() }));
+            } while(tryConsume(','));
+            expect(']');
+            return samples;
+        }
+
+        void skipValue()
+        {
+            skipWhitespace();
+            if(m_position >= m_text.size()) fail("value");
+            const char character = m_text.at(m_position);
+            if(character == '"')
+            {
+                readString();
+            }
+            else if(character == '[' || character == '{')
+            {
+                const char closing = character == '[' ? ']' : '}';
+                m_position++;
+                if(tryConsume(closing)) return;
+                do
+                {
+                    if(closing == '}')
+                    {
+                        readString();
+                        expect(':');
+                    }
+                    skipValue();
+                } while(tryConsume(','));
+                expect(closing);
+            }
+            else
+            {
+                // Numbers and literals
+                const std::string delimiters = ",]} \t\r\n";
+                while(m_position < m_text.size() && delimiters.find(m_text.at(m_position)) == std::string::npos)
+                {
+                    m_position++;
+                }
+            }
+        }
+
+        std::string readString()
+        {
+            expect('"');
+            std::string value;
+            while(m_position < m_text.size() && m_text.at(m_position) != '"')
+            {
+                char character = m_text.at(m_position++);
+                if(character == '\\')
+                {
+                    if(m_position >= m_text.size()) fail("escape sequence");
+                    character = m_text.at(m_position++);
+                    switch(character)
+                    {
+                        case 'n': character = '\n'; break;
+                        case 'r': character = '\r'; break;
+                        case 't': character = '\t'; break;
+                        case 'u':
+                            if(m_position + 4 > m_text.size()) fail("unicode escape");
+                            character = static_cast<char>(std::stoi(m_text.substr(m_position, 4), nullptr, 16));
+                            m_position += 4;
+                            break;
+                        default: break;
+                    }
+                }
+                value += character;
+            }
+            expect('"');
+            return value;
+        }
+
+        double readNumber()
+        {
+            skipWhitespace();
+            size_t parsedLength = 0;
+            double value = 0.0;
+            try
+            {
+                value = std::stod(m_text.substr(m_position, 32), &parsedLength);
+            }
+            catch(const std::logic_error &)
+            {
+                fail("number");
+            }
+            m_position += parsedLength;
+            return value;
+        }
+
+        void skipWhitespace()
+        {
+            while(m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text.at(m_position))))
+            {
+                m_position++;
+            }
+        }
 
-            filterProcessingDurations.push_back(std::get<0>(meanAndAverageFilterDurations));
-            filterProcessingDurations.push_back(std::get<1>(meanAndAverageFilterDurations));
+        bool tryConsume(const char character)
+        {
+            skipWhitespace();
+            if(m_position < m_text.size() && m_text.at(m_position) == character)
+            {
+                m_position++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(const char character)
+        {
+            if(!tryConsume(character)) fail(std::string("'") + character + "'");
+        }
+
+        [[noreturn]] void fail(const std::string &expected) const
+        {
+            throw std::runtime_error("Invalid benchmark results, expected " + expected + " at offset "
+                                     + std::to_string(m_position));
+        }
+
+        std::string m_text;
+        size_t m_position = 0;
+    };
+
+    SavedResults readJsonResults(const std::string &fileName)
+    {
+        std::ifstream file(fileName);
+        if(!file) throw std::runtime_error("Failed to open " + fileName);
+        std::stringstream text;
+        text << file.rdbuf();
+        return JsonResultsReader{ text.str() }.read();
+    }
+
+    struct ComparisonOptions
+    {
+        double regressionThreshold = 5.0; // Percent increase of the median
+        double significanceLevel = 0.01;
+    };
+
+    // Two-sided Mann-Whitney U test using the normal approximation with tie correction
+    double computeMannWhitneyPValue(const std::vector<Duration> &first, const std::vector<Duration> &second)
+    {
+        const auto numFirst = static_cast<double>(first.size());
+        const auto numSecond = static_cast<double>(second.size());
+        const auto numTotal = numFirst + numSecond;
+
+        std::vector<std::pair<Duration, bool>> combined;
+        for(const auto &sample : first) combined.emplace_back(sample, true);
+        for(const auto &sample : second) combined.emplace_back(sample, false);
+        std::sort(combined.begin(), combined.end());
+
+        double rankSumFirst = 0.0;
+        double tieCorrection = 0.0;
+        for(size_t i = 0; i < combined.size();)
+        {
+            size_t j = i;
+            while(j < combined.size() && combined.at(j).first == combined.at(i).first) j++;
+            const double averageRank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+            const auto numTied = static_cast<double>(j - i);
+            tieCorrection += numTied * numTied * numTied - numTied;
+            for(size_t k = i; k < j; k++)
+            {
+                if(combined.at(k).second) rankSumFirst += averageRank;
+            }
+            i = j;
+        }
+
+        const double u = rankSumFirst - numFirst * (numFirst + 1.0) / 2.0;
+        const double mean = numFirst * numSecond / 2.0;
+        const double variance =
+            numFirst * numSecond / 12.0 * ((numTotal + 1.0) - tieCorrection / (numTotal * (numTotal - 1.0)));
+        if(variance <= 0.0) return 1.0;
+
+        const double difference = std::max(std::abs(u - mean) - 0.5, 0.0); // Continuity correction
+        return std::erfc(difference / std::sqrt(variance) / std::sqrt(2.0));
+    }
+
+    // Prints one line per measurement and returns the number of significant regressions
+    size_t compareWithBaseline(const SavedResults &baseline,
+                               const SystemInfo &currentSystemInfo,
+                               const std::vector<Measurement> &currentResults,
+                               const ComparisonOptions &options)
+    {
+        const auto &baselineResults = baseline.results.measurements;
+        printPrimarySeparationLine();
+        std::cout << "Comparison with baseline from " << baseline.systemInfo.date << ":" << std::endl;
+        std::cout << "  Baseline: API " << baseline.systemInfo.api << ", camera " << baseline.systemInfo.camera
+                  << std::endl;
+        std::cout << "  Current:  API " << currentSystemInfo.api << ", camera " << currentSystemInfo.camera
+                  << std::endl;
+        std::cout << "  Regression: median more than " << options.regressionThreshold << "% slower with p < "
+                  << options.significanceLevel << " (Mann-Whitney U)" << std::endl;
+        printSecondarySeparationLine();
+
+        std::cout << std::right << std::setfill(' ') << std::setw(12) << "Baseline" << std::setw(12) << "Current"
+                  << std::setw(10) << "Change" << std::setw(10) << "p-value" << "  " << std::left << std::setw(12)
+                  << "Status"
+                  << "Measurement" << std::endl;
+
+        size_t numRegressions = 0;
+        for(const auto &current : currentResults)
+        {
+            const auto baselineMeasurement =
+                std::find_if(baselineResults.begin(), baselineResults.end(), [&current](const Measurement &m) {
+                    return m.section == current.section && m.name == current.name;
+                });
+            const auto label = current.section + ": " + current.name;
+            if(baselineMeasurement == baselineResults.end() || baselineMeasurement->samples.empty())
+            {
+                std::cout << std::right << std::setw(12) << "-" << std::setw(12)
+                          << valueToStringWithPrecision(toMilliseconds(computeMedianDuration(current.samples)), 3)
+                          << std::setw(10) << "-"
+                          << std::setw(10) << "-"
+                          << "  " << std::left << std::setw(12) << "new" << label << std::endl;
+                continue;
+            }
+
+            const auto baselineMedian = toMilliseconds(computeMedianDuration(baselineMeasurement->samples));
+            const auto currentMedian = toMilliseconds(computeMedianDuration(current.samples));
+            const double change =
+                baselineMedian > 0.0 ? (currentMedian - baselineMedian) / baselineMedian * 100.0 : 0.0;
+            const double pValue = computeMannWhitneyPValue(baselineMeasurement->samples, current.samples);
+            const bool significant = pValue < options.significanceLevel;
+
+            std::string status = "ok";
+            if(significant && change > options.regressionThreshold)
+            {
+                status = "REGRESSION";
+                numRegressions++;
+            }
+            else if(significant && change < -options.regressionThreshold)
+            {
+                status = "improved";
+            }
+
+            std::cout << std::right << std::setw(12) << valueToStringWithPrecision(baselineMedian, 3) << std::setw(12)
+                      << valueToStringWithPrecision(currentMedian, 3) << std::setw(9)
+                      << valueToStringWithPrecision(change, 1) << "%" << std::setw(10)
+                      << valueToStringWithPrecision(pValue, 4) << "  " << std::left << std::setw(12) << status << label
+                      << std::endl;
+        }
+
+        for(const auto &baselineMeasurement : baselineResults)
+        {
+            const auto found = std::find_if(
+                currentResults.begin(), currentResults.end(), [&baselineMeasurement](const Measurement &m) {
+                    return m.section == baselineMeasurement.section && m.name == baselineMeasurement.name;
+                });
+            if(found == currentResults.end())
+            {
+                std::cout << "  Not measured in this run: " << baselineMeasurement.section << ": "
+                          << baselineMeasurement.name << std::endl;
+            }
+        }
+
+        printSecondarySeparationLine();
+        std::cout << "  Medians in ms, " << numRegressions << " regression(s)" << std::endl;
+        return numRegressions;
+    }
+
+    // Counts measurement iterations and stops early when the time budget of the loop is used up
+    class IterationLimit
+    {
+    public:
+        IterationLimit(const size_t numIterations, const Duration &timeBudget)
+            : m_numIterations{ numIterations }
+            , m_timeBudget{ timeBudget }
+            , m_start{ HighResClock::now() }
+        {}
+
+        bool next()
+        {
+            if(m_iteration == m_numIterations) return false;
+            if(m_iteration > 0 && m_timeBudget != Duration::zero() && HighResClock::now() - m_start >= m_timeBudget)
+            {
+                std::cout << "  Time budget reached after " << m_iteration << " of " << m_numIterations
+                          << " iterations" << std::endl;
+                m_numIterations = m_iteration;
+                return false;
+            }
+            m_iteration++;
+            return true;
+        }
+
+    private:
+        size_t m_numIterations;
+        size_t m_iteration = 0;
+        Duration m_timeBudget;
+        HighResClock::time_point m_start;
+    };
+
+    bool isSelected(const BenchmarkOptions &options, const std::string &section)
+    {
+        return std::find(options.sections.begin(), options.sections.end(), section) != options.sections.end();
+    }
+
+    size_t getMinExposureTime(const std::string &modelName)
+    {
+        if(modelName.substr(0, 14) == "Zivid One Plus")
+        {
+            return 6500; // Min for Zivid One Plus
+        }
+
+        return 8333; // Min for Zivid One
+    }
+
+    std::vector<Zivid::Settings> makeSettingsVector(const std::vector<unsigned int> &irises,
+                                                    const std::vector<size_t> &exposureTimes,
+                                                    const bool enableGaussian,
+                                                    const bool enableReflection)
+    {
+        std::vector<Zivid::Settings> settingsVector(irises.size());
+
+        Zivid::Settings::Filters filters;
+        filters.set(Zivid::Settings::Filters::Contrast::Enabled{ true });
+        filters.set(Zivid::Settings::Filters::Outlier::Enabled{ true });
+        filters.set(Zivid::Settings::Filters::Saturated::Enabled{ true });
+        filters.set(Zivid::Settings::Filters::Gaussian::Enabled{ enableGaussian });
+        filters.set(Zivid::Settings::Filters::Reflection::Enabled{ enableReflection });
+
+        Zivid::Settings settings;
+        for(size_t i = 0; i < irises.size(); ++i)
+        {
+            settings.set(Zivid::Settings::Iris{ irises.at(i) });
+            settings.set(Zivid::Settings::Filters{ filters });
+            settings.set(Zivid::Settings::ExposureTime{ std::chrono::microseconds{ exposureTimes.at(i) } });
+            settingsVector.at(i) = settings;
+        }
+        return settingsVector;
+    }
+
+    // Parses "<iris>[:<exposure time in us>],..." into one HDR set, e.g. "14:6500,21,35"
+    HDRSet parseHDRSet(const std::string &text, const size_t defaultExposureTime)
+    {
+        HDRSet hdrSet;
+        std::istringstream frames(text);
+        std::string frame;
+        while(std::getline(frames, frame, ','))
+        {
+            const auto separator = frame.find(':');
+            try
+            {
+                size_t parsedLength = 0;
+                const auto iris = std::stoul(frame.substr(0, separator), &parsedLength);
+                if(parsedLength != frame.substr(0, separator).size()) throw std::invalid_argument(frame);
+                hdrSet.irises.push_back(static_cast<unsigned int>(iris));
+                hdrSet.exposureTimes.push_back(
+                    separator == std::string::npos ? defaultExposureTime : std::stoul(frame.substr(separator + 1)));
+            }
+            catch(const std::logic_error &)
+            {
+                throw std::invalid_argument("Invalid HDR set '" + text + "', expected <iris>[:<exposure time>],...");
+            }
+        }
+        if(hdrSet.irises.empty()) throw std::invalid_argument("Empty HDR set");
+        return hdrSet;
+    }
+
+    std::vector<HDRSet> makeDefaultHDRSets(const size_t exposureTime)
+    {
+        return { { { 21U }, { exposureTime } },
+                 { { 17U, 27U }, { exposureTime, exposureTime } },
+                 { { 14U, 21U, 35U }, { exposureTime, exposureTime, exposureTime } } };
+    }
+
+    void benchmarkConnect(Zivid::Camera &camera, const BenchmarkOptions &options, BenchmarkResults &results)
+    {
+        printConnectHeader(options.numConnects);
+        const MemoryProbe memoryProbe;
+
+        std::vector<Duration> connectDurations;
+        std::vector<Duration> disconnectDurations;
+
+        IterationLimit iterations(options.numConnects, options.timeBudget);
+        while(iterations.next())
+        {
+            const auto beforeConnect = HighResClock::now();
+            camera.connect();
+            const auto afterConnect = HighResClock::now();
+            camera.disconnect();
+            const auto afterDisconnect = HighResClock::now();
+
+            connectDurations.push_back(afterConnect - beforeConnect);
+            disconnectDurations.push_back(afterDisconnect - afterConnect);
+            results.trace.record("Connect", "connect", "Connect", beforeConnect, afterConnect);
+            results.trace.record("Disconnect", "connect", "Connect", afterConnect, afterDisconnect);
+        }
+
+        reportResults({ { "Connect", "Connect", connectDurations }, { "Connect", "Disconnect", disconnectDurations } },
+                      memoryProbe,
+                      results);
+    }
+
+    std::string makeCapture3DSectionName(const std::vector<Zivid::Settings> &settingsVector)
+    {
+        const auto filterList = makefilterList(settingsVector);
+        return "Capture 3D, iris " + makeSettingList<Zivid::Settings::Iris>(settingsVector) + ", exposure time "
+               + makeSettingList<Zivid::Settings::ExposureTime>(settingsVector)
+               + (filterList.empty() ? "" : ", filters " + filterList);
+    }
+
+    struct Capture3DDurations
+    {
+        std::vector<Duration> acquisition;
+        std::vector<Duration> processing;
+        std::vector<Duration> total;
+    };
+
+    Capture3DDurations benchmarkCapture3D(Zivid::Camera &camera,
+                                          const std::vector<Zivid::Settings> &settingsVector,
+                                          const BenchmarkOptions &options,
+                                          BenchmarkResults &results)
+    {
+        printCapture3DHeader(options.numFrames3D, settingsVector);
+        const MemoryProbe memoryProbe;
+        const auto section = makeCapture3DSectionName(settingsVector);
+
+        for(size_t i = 0; i < options.numWarmups; i++) // Warmup frames
+        {
+            const auto beforeCapture = HighResClock::now();
+            const auto frame = Zivid::HDR::capture(camera, settingsVector);
+            const auto afterCapture = HighResClock::now();
+            frame.getPointCloud();
+            const auto afterProcess = HighResClock::now();
+
+            results.trace.record(
+                "3D image acquisition", "capture,warmup", section.c_str(), beforeCapture, afterCapture);
+            results.trace.record(
+                "Point cloud processing", "processing,warmup", section.c_str(), afterCapture, afterProcess);
+        }
+
+        std::vector<Duration> captureDurations;
+        std::vector<Duration> processDurations;
+        std::vector<Duration> totalDurations;
+
+        IterationLimit iterations(options.numFrames3D, options.timeBudget);
+        while(iterations.next())
+        {
+            const auto beforeCapture = HighResClock::now();
+            const auto frame = Zivid::HDR::capture(camera, settingsVector);
+            const auto afterCapture = HighResClock::now();
+            frame.getPointCloud();
+            const auto afterProcess = HighResClock::now();
+
+            captureDurations.push_back(afterCapture - beforeCapture);
+            processDurations.push_back(afterProcess - afterCapture);
+            totalDurations.push_back(afterProcess - beforeCapture);
+            results.trace.record("3D image acquisition", "capture", section.c_str(), beforeCapture, afterCapture);
+            results.trace.record("Point cloud processing", "processing", section.c_str(), afterCapture, afterProcess);
+        }
+
+        reportResults({ { section, "3D image acquisition time", captureDurations },
+                        { section, "Point cloud processing time", processDurations },
+                        { section, "Total 3D capture time", totalDurations } },
+                      memoryProbe,
+                      results);
+
+        return { captureDurations, processDurations, totalDurations };
+    }
+
+    void benchmarkAssistedCapture3D(Zivid::Camera &camera, const BenchmarkOptions &options, BenchmarkResults &results)
+    {
+        printAssistedCapture3DHeader(options.numFrames3D);
+        const MemoryProbe memoryProbe;
+
+        Zivid::CaptureAssistant::SuggestSettingsParameters suggestSettingsParameters(
+            std::chrono::milliseconds{ 1200 }, Zivid::CaptureAssistant::AmbientLightFrequency::none);
+
+        for(size_t i = 0; i < options.numWarmups; i++) // Warmup
+        {
+            const auto settingsVector{ Zivid::CaptureAssistant::suggestSettings(camera, suggestSettingsParameters) };
+        }
+
+        std::vector<Duration> suggestSettingsDurations;
+
+        IterationLimit iterations(options.numFrames3D, options.timeBudget);
+        while(iterations.next())
+        {
+            const auto beforeSuggestSettings = HighResClock::now();
+            const auto settingsVector{ Zivid::CaptureAssistant::suggestSettings(camera, suggestSettingsParameters) };
+            const auto afterSuggestSettings = HighResClock::now();
+
+            suggestSettingsDurations.push_back(afterSuggestSettings - beforeSuggestSettings);
+            results.trace.record(
+                "Suggest settings", "capture", "Assisted capture", beforeSuggestSettings, afterSuggestSettings);
+        }
+
+        reportResults(
+            { { "Assisted capture", "Suggest settings time", suggestSettingsDurations } }, memoryProbe, results);
+    }
+
+    ResultLine benchmarkFilterProcessing(const std::string &filterName,
+                                         const std::vector<Duration> &captureDuration,
+                                         const std::vector<Duration> &captureDurationFilter)
+    {
+        return { "  " + filterName + ":",
+                 computeMedianDuration(captureDurationFilter) - computeMedianDuration(captureDuration),
+                 computeAverageDuration(captureDurationFilter) - computeAverageDuration(captureDuration) };
+    }
+
+    void benchmarkCapture3DAndFilters(Zivid::Camera &camera,
+                                      const HDRSet &hdrSet,
+                                      const BenchmarkOptions &options,
+                                      BenchmarkResults &results)
+    {
+        const std::vector<Duration> captureDurationWithoutFilter =
+            benchmarkCapture3D(
+                camera, makeSettingsVector(hdrSet.irises, hdrSet.exposureTimes, false, false), options, results)
+                .total;
+
+        std::vector<bool> gaussian{ true, false, true };
+        std::vector<bool> reflection{ false, true, true };
+        std::vector<std::string> filterNames{ "Gaussian", "Reflection", "Gaussian and Reflection" };
+
+        std::vector<ResultLine> filterProcessingDurations;
+        for(size_t i = 0; i < gaussian.size(); i++)
+        {
+            const std::vector<Duration> captureDurationWithFilter =
+                benchmarkCapture3D(camera,
+                                   makeSettingsVector(
+                                       hdrSet.irises, hdrSet.exposureTimes, gaussian.at(i), reflection.at(i)),
+                                   options,
+                                   results)
+                    .total;
+
+            filterProcessingDurations.push_back(
+                benchmarkFilterProcessing(filterNames.at(i), captureDurationWithoutFilter, captureDurationWithFilter));
         }
         printFilterResults(filterProcessingDurations);
     }
 
+    // Least squares fit of milliseconds = fixed + perFrame * frames, with the coefficient of determination
+    CostModel fitCostModel(const std::string &name,
+                           const std::vector<double> &frameCounts,
+                           const std::vector<double> &milliseconds)
+    {
+        const auto numValues = static_cast<double>(frameCounts.size());
+        const double meanFrames = std::accumulate(frameCounts.begin(), frameCounts.end(), 0.0) / numValues;
+        const double meanMilliseconds = std::accumulate(milliseconds.begin(), milliseconds.end(), 0.0) / numValues;
+
+        double covariance = 0.0;
+        double variance = 0.0;
+        for(size_t i = 0; i < frameCounts.size(); i++)
+        {
+            covariance += (frameCounts.at(i) - meanFrames) * (milliseconds.at(i) - meanMilliseconds);
+            variance += (frameCounts.at(i) - meanFrames) * (frameCounts.at(i) - meanFrames);
+        }
+        const double perFrame = covariance / variance;
+        const double fixed = meanMilliseconds - perFrame * meanFrames;
+
+        double residualSumOfSquares = 0.0;
+        double totalSumOfSquares = 0.0;
+        for(size_t i = 0; i < frameCounts.size(); i++)
+        {
+            const double residual = milliseconds.at(i) - (fixed + perFrame * frameCounts.at(i));
+            residualSumOfSquares += residual * residual;
+            totalSumOfSquares += (milliseconds.at(i) - meanMilliseconds) * (milliseconds.at(i) - meanMilliseconds);
+        }
+        const double rSquared = totalSumOfSquares > 0.0 ? 1.0 - residualSumOfSquares / totalSumOfSquares : 1.0;
+
+        return { name, fixed, perFrame, rSquared };
+    }
+
+    // Irises spread evenly over the range used by the default HDR sets
+    HDRSet makeSweepHDRSet(const size_t numFrames, const size_t exposureTime)
+    {
+        const double minIris = 14.0;
+        const double maxIris = 35.0;
+        HDRSet hdrSet;
+        for(size_t i = 0; i < numFrames; i++)
+        {
+            const double fraction = numFrames > 1 ? static_cast<double>(i) / static_cast<double>(numFrames - 1) : 0.5;
+            hdrSet.irises.push_back(static_cast<unsigned int>(std::round(minIris + fraction * (maxIris - minIris))));
+            hdrSet.exposureTimes.push_back(exposureTime);
+        }
+        return hdrSet;
+    }
+
+    void printCostModel(const CostModel &costModel)
+    {
+        printFormated({ "  " + costModel.name + ":",
+                        formatDuration(std::chrono::duration_cast<Duration>(
+                            std::chrono::duration<double, std::milli>{ costModel.fixedMilliseconds })),
+                        formatDuration(std::chrono::duration_cast<Duration>(
+                            std::chrono::duration<double, std::milli>{ costModel.perFrameMilliseconds }))
+                            + "    " + valueToStringWithPrecision(costModel.rSquared, 4) });
+    }
+
+    // Captures HDR frames with 1 to maxSweepFrames settings and fits a fixed plus per frame cost to the medians
+    void benchmarkHDRSweep(Zivid::Camera &camera,
+                           const size_t exposureTime,
+                           const BenchmarkOptions &options,
+                           BenchmarkResults &results)
+    {
+        std::vector<double> frameCounts;
+        std::vector<double> acquisitionMedians;
+        std::vector<double> processingMedians;
+        std::vector<double> totalMedians;
+        for(size_t numFrames = 1; numFrames <= options.maxSweepFrames; numFrames++)
+        {
+            const auto hdrSet = makeSweepHDRSet(numFrames, exposureTime);
+            const auto durations = benchmarkCapture3D(
+                camera, makeSettingsVector(hdrSet.irises, hdrSet.exposureTimes, false, false), options, results);
+
+            frameCounts.push_back(static_cast<double>(numFrames));
+            acquisitionMedians.push_back(toMilliseconds(computeMedianDuration(durations.acquisition)));
+            processingMedians.push_back(toMilliseconds(computeMedianDuration(durations.processing)));
+            totalMedians.push_back(toMilliseconds(computeMedianDuration(durations.total)));
+        }
+
+        const std::vector<CostModel> costModels{ fitCostModel("Acquisition", frameCounts, acquisitionMedians),
+                                                 fitCostModel("Processing", frameCounts, processingMedians),
+                                                 fitCostModel("Total", frameCounts, totalMedians) };
+
+        printPrimarySeparationLine();
+        std::cout << "HDR cost model, 1 to " << options.maxSweepFrames << " frames (fit to medians):" << std::endl;
+        printSecondarySeparationLine();
+        printFormated({ "  Time:", "Fixed", "Per frame    R^2" });
+        for(const auto &costModel : costModels)
+        {
+            printCostModel(costModel);
+        }
+        results.costModels.insert(results.costModels.end(), costModels.begin(), costModels.end());
+    }
+
     Zivid::Settings2D makeSettings2D(const size_t exposureTime)
     {
         Zivid::Settings2D settings;
@@ -399,90 +1642,893 @@ namespace
         return settings;
     }
 
-    void benchmarkCapture2D(Zivid::Camera &camera, const Zivid::Settings2D &settings, const size_t numFrames)
+    void benchmarkCapture2D(Zivid::Camera &camera,
+                            const Zivid::Settings2D &settings,
+                            const BenchmarkOptions &options,
+                            BenchmarkResults &results)
     {
-        printCapture2DHeader(numFrames, settings);
+        printCapture2DHeader(options.numFrames2D, settings);
+        const MemoryProbe memoryProbe;
 
-        for(size_t i = 0; i < 5; i++) // Warmup frames
+        for(size_t i = 0; i < options.numWarmups; i++) // Warmup frames
         {
+            const auto beforeCapture = HighResClock::now();
             camera.capture2D(settings);
+            const auto afterCapture = HighResClock::now();
+
+            results.trace.record("2D capture", "capture,warmup", "Capture 2D", beforeCapture, afterCapture);
         }
 
         std::vector<Duration> captureDurations;
-        std::vector<Duration> allDurations;
 
-        for(size_t i = 0; i < numFrames; i++)
+        IterationLimit iterations(options.numFrames2D, options.timeBudget);
+        while(iterations.next())
         {
             const auto beforeCapture = HighResClock::now();
             const auto frame2D = camera.capture2D(settings);
             const auto afterCapture = HighResClock::now();
 
             captureDurations.push_back(afterCapture - beforeCapture);
+            results.trace.record("2D capture", "capture", "Capture 2D", beforeCapture, afterCapture);
         }
-        allDurations.push_back(computeMedianDuration(captureDurations));
-        allDurations.push_back(computeAverageDuration(captureDurations));
 
-        printCapture2DResults(allDurations);
+        reportResults({ { "Capture 2D", "Total 2D capture time", captureDurations } }, memoryProbe, results);
     }
 
-    void benchmarkSave(Zivid::Camera &camera, const size_t numFrames)
+    size_t getFileSize(const std::string &fileName)
     {
-        printSaveHeader(numFrames);
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if(!file) throw std::runtime_error("Failed to open " + fileName);
+        return static_cast<size_t>(file.tellg());
+    }
+
+    void readFile(const std::string &fileName, std::vector<char> &buffer)
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        if(!file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+        {
+            throw std::runtime_error("Failed to read " + fileName);
+        }
+    }
+
+    bool isFileFlushSupported()
+    {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Writes the file to disk and optionally evicts it from the page cache, so that the next read comes from disk
+    void flushFile(const std::string &fileName, const bool evictFromPageCache)
+    {
+#ifdef __linux__
+        const int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+        if(fileDescriptor < 0) throw std::runtime_error("Failed to open " + fileName);
+        const bool synced = fsync(fileDescriptor) == 0;
+        const bool evicted = !evictFromPageCache || posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(fileDescriptor);
+        if(!synced || !evicted) throw std::runtime_error("Failed to flush " + fileName);
+#else
+        static_cast<void>(evictFromPageCache);
+        throw std::runtime_error("Flushing " + fileName + " is only supported on Linux");
+#endif
+    }
+
+    void benchmarkSave(Zivid::Camera &camera, const BenchmarkOptions &options, BenchmarkResults &results)
+    {
+        printSaveHeader(options.numFramesSave, options.syncSaves, options.coldPageCache);
 
         auto frame = camera.capture();
         frame.getPointCloud();
 
-        std::vector<Duration> allDurations;
-        std::vector<std::string> fileNames{ "Zivid3D.zdf", "Zivid3D.ply", "Zivid3D.pcd", "Zivid3D.xyz" };
-        for(const auto &fileName : fileNames)
+        const MemoryProbe memoryProbe;
+        std::vector<Measurement> measurements;
+        /*
+		frame.save picks the file format from the extension, so the file names keep the lowercase extensions. The
+		files get names of their own and are removed afterwards, so that the Zivid3D.zdf sample processed by the
+		scaling section is never replaced by this capture.
+		*/
+        const std::vector<std::pair<std::string, std::string>> formats{
+            { "ZDF", "zdf" }, { "PLY", "ply" }, { "PCD", "pcd" }, { "XYZ", "xyz" }
+        };
+        for(const auto &format : formats)
         {
-            std::vector<Duration> durationsPerFormat;
-            for(size_t j = 0; j < numFrames; j++)
+            const auto &formatName = format.first;
+            const auto fileName = "ZividBenchmarkSave." + format.second;
+            const auto saveName = "Save " + formatName;
+            std::vector<Duration> saveDurations;
+            IterationLimit saveIterations(options.numFramesSave, options.timeBudget);
+            while(saveIterations.next())
             {
                 const auto beforeSave = HighResClock::now();
                 frame.save(fileName);
+                if(options.syncSaves) flushFile(fileName, false);
                 const auto afterSave = HighResClock::now();
 
-                durationsPerFormat.push_back(afterSave - beforeSave);
+                saveDurations.push_back(afterSave - beforeSave);
+                results.trace.record(saveName.c_str(), "save", "Save", beforeSave, afterSave);
+            }
+            const auto fileSize = getFileSize(fileName);
+            measurements.push_back({ "Save", saveName, saveDurations, 0, fileSize });
+
+            // Only ZDF can be loaded back into a Zivid::Frame, the other formats are read as raw bytes
+            const bool isZDF = formatName == "ZDF";
+            const auto loadName = (isZDF ? "Load " : "Read ") + formatName;
+            std::vector<char> buffer(isZDF ? 0 : fileSize);
+            std::vector<Duration> loadDurations;
+            IterationLimit loadIterations(options.numFramesSave, options.timeBudget);
+            while(loadIterations.next())
+            {
+                if(options.coldPageCache) flushFile(fileName, true);
+
+                const auto beforeLoad = HighResClock::now();
+                if(isZDF)
+                {
+                    const Zivid::Frame loadedFrame(fileName);
+                    loadedFrame.getPointCloud();
+                }
+                else
+                {
+                    readFile(fileName, buffer);
+                }
+                const auto afterLoad = HighResClock::now();
+
+                loadDurations.push_back(afterLoad - beforeLoad);
+                results.trace.record(loadName.c_str(), "load", "Save", beforeLoad, afterLoad);
+            }
+            measurements.push_back({ "Save", loadName, loadDurations, 0, fileSize });
+            std::remove(fileName.c_str());
+        }
+        reportResults(measurements, memoryProbe, results);
+    }
+
+    template<typename Conversion>
+    Measurement benchmarkConversion(const std::string &name,
+                                    const size_t numPoints,
+                                    const BenchmarkOptions &options,
+                                    TraceRecorder &trace,
+                                    Conversion &&conversion)
+    {
+        const std::string section = "Post-processing";
+        for(size_t i = 0; i < options.numWarmups; i++)
+        {
+            const auto beforeConversion = HighResClock::now();
+            conversion();
+            const auto afterConversion = HighResClock::now();
+
+            trace.record(name.c_str(), "postprocessing,warmup", section.c_str(), beforeConversion, afterConversion);
+        }
+
+        std::vector<Duration> durations;
+        IterationLimit iterations(options.numConversions, options.timeBudget);
+        while(iterations.next())
+        {
+            const auto beforeConversion = HighResClock::now();
+            conversion();
+            const auto afterConversion = HighResClock::now();
+
+            durations.push_back(afterConversion - beforeConversion);
+            trace.record(name.c_str(), "postprocessing", section.c_str(), beforeConversion, afterConversion);
+        }
+        return { section, name, durations, numPoints };
+    }
+
+#ifdef BENCHMARK_WITH_OPENCV
+    struct OpenCVImages
+    {
+        cv::Mat rgb;
+        cv::Mat x;
+        cv::Mat y;
+        cv::Mat z;
+    };
+
+    bool isLesserOrNaN(const float a, const float b)
+    {
+        return a < b ? true : std::isnan(a);
+    }
+
+    bool isGreaterOrNaN(const float a, const float b)
+    {
+        return a > b ? true : std::isnan(a);
+    }
+
+    // As in CreateDepthMap: RGB image and X, Y and Z scaled to 8 bit between their min and max values
+    OpenCVImages convertToOpenCV(const Zivid::PointCloud &pointCloud)
+    {
+        const auto rows = static_cast<int>(pointCloud.height());
+        const auto cols = static_cast<int>(pointCloud.width());
+        OpenCVImages images{ cv::Mat(rows, cols, CV_8UC3, cv::Scalar(0, 0, 0)),
+                             cv::Mat(rows, cols, CV_8UC1, cv::Scalar(0)),
+                             cv::Mat(rows, cols, CV_8UC1, cv::Scalar(0)),
+                             cv::Mat(rows, cols, CV_8UC1, cv::Scalar(0)) };
+
+        const auto *begin = pointCloud.dataPtr();
+        const auto *end = pointCloud.dataPtr() + pointCloud.size();
+        const auto maxX = std::max_element(begin, end, [](const Zivid::Point &a, const Zivid::Point &b) {
+            return isLesserOrNaN(a.x, b.x);
+        });
+        const auto minX = std::max_element(begin, end, [](const Zivid::Point &a, const Zivid::Point &b) {
+            return isGreaterOrNaN(a.x, b.x);
+        });
+        const auto maxY = std::max_element(begin, end, [](const Zivid::Point &a, const Zivid::Point &b) {
+            return isLesserOrNaN(a.y, b.y);
+        });
+        const auto minY = std::max_element(begin, end, [](const Zivid::Point &a, const Zivid::Point &b) {
+            return isGreaterOrNaN(a.y, b.y);
+        });
+        const auto maxZ = std::max_element(begin, end, [](const Zivid::Point &a, const Zivid::Point &b) {
+            return isLesserOrNaN(a.z, b.z);
+        });
+        const auto minZ = std::max_element(begin, end, [](const Zivid::Point &a, const Zivid::Point &b) {
+            return isGreaterOrNaN(a.z, b.z);
+        });
+
+        for(int i = 0; i < rows; i++)
+        {
+            for(int j = 0; j < cols; j++)
+            {
+                const auto &point = pointCloud(i, j);
+                cv::Vec3b &color = images.rgb.at<cv::Vec3b>(i, j);
+                color[0] = point.blue();
+                color[1] = point.green();
+                color[2] = point.red();
+
+                if(!std::isnan(point.z))
+                {
+                    images.x.at<uchar>(i, j) =
+                        static_cast<unsigned char>((255.0f * (point.x - minX->x) / (maxX->x - minX->x)));
+                    images.y.at<uchar>(i, j) =
+                        static_cast<unsigned char>((255.0f * (point.y - minY->y) / (maxY->y - minY->y)));
+                    images.z.at<uchar>(i, j) =
+                        static_cast<unsigned char>((255.0f * (point.z - minZ->z) / (maxZ->z - minZ->z)));
+                }
+            }
+        }
+        return images;
+    }
+
+    // As in CreateDepthMap: jet color map with missing points set to black
+    cv::Mat colorDepthMap(const cv::Mat &z, const Zivid::PointCloud &pointCloud)
+    {
+        cv::Mat zJetColorMap;
+        cv::applyColorMap(z, zJetColorMap, cv::COLORMAP_JET);
+
+        for(int i = 0; i < zJetColorMap.rows; i++)
+        {
+            for(int j = 0; j < zJetColorMap.cols; j++)
+            {
+                if(std::isnan(pointCloud(i, j).z))
+                {
+                    zJetColorMap.at<cv::Vec3b>(i, j) = cv::Vec3b(0, 0, 0);
+                }
+            }
+        }
+        return zJetColorMap;
+    }
+#endif
+
+#ifdef BENCHMARK_WITH_EIGEN3
+    float nanToZero(const float x)
+    {
+        return std::isnan(x) ? 0.0f : x;
+    }
+
+    // Helpers for downsample(), as in the Downsample sample
+    Eigen::MatrixXf lineSum(Eigen::MatrixXf matrix, const int downsamplingFactor)
+    {
+        Eigen::Map<Eigen::MatrixXf> flattenedMatrixMap(matrix.data(),
+                                                       downsamplingFactor,
+                                                       matrix.rows() * matrix.cols() / downsamplingFactor);
+        Eigen::MatrixXf flattenedMatrixNansRemoved =
+            flattenedMatrixMap.unaryExpr([](const float f) { return nanToZero(f); });
+        Eigen::MatrixXf flattenedMatrixColwiseSum = flattenedMatrixNansRemoved.colwise().sum();
+        Eigen::Map<Eigen::MatrixXf> reshapedMatrixMap(flattenedMatrixColwiseSum.data(),
+                                                      matrix.rows() / downsamplingFactor,
+                                                      matrix.cols());
+        return reshapedMatrixMap;
+    }
+
+    Eigen::MatrixXf gridSum(const Eigen::MatrixXf &matrix, const int downsamplingFactor)
+    {
+        return lineSum(lineSum(matrix, downsamplingFactor).transpose(), downsamplingFactor).transpose();
+    }
+
+    Eigen::MatrixXi downsampleAndRound(const Eigen::MatrixXi &matrixi, const int downsamplingFactor)
+    {
+        const Eigen::MatrixXf matrixf = matrixi.cast<float>();
+        const auto roundFunctor = [](const float f) { return std::round(f); };
+        return ((gridSum(matrixf, downsamplingFactor) / static_cast<float>(downsamplingFactor * downsamplingFactor))
+                    .unaryExpr(roundFunctor))
+            .cast<int>();
+    }
+
+    // As in the Downsample sample: contrast weighted average over downsamplingFactor x downsamplingFactor cells
+    Zivid::PointCloud downsample(const Zivid::PointCloud &pointCloud, const int downsamplingFactor)
+    {
+        const auto rows = static_cast<Eigen::Index>(pointCloud.height());
+        const auto cols = static_cast<Eigen::Index>(pointCloud.width());
+        Eigen::MatrixXf x(rows, cols);
+        Eigen::MatrixXf y(rows, cols);
+        Eigen::MatrixXf z(rows, cols);
+        Eigen::MatrixXi r(rows, cols);
+        Eigen::MatrixXi g(rows, cols);
+        Eigen::MatrixXi b(rows, cols);
+        Eigen::MatrixXf contrast(rows, cols);
+
+        for(Eigen::Index i = 0; i < rows; i++)
+        {
+            for(Eigen::Index j = 0; j < cols; j++)
+            {
+                const auto &point = pointCloud(i, j);
+                x(i, j) = point.x;
+                y(i, j) = point.y;
+                z(i, j) = point.z;
+                r(i, j) = point.red();
+                g(i, j) = point.green();
+                b(i, j) = point.blue();
+                contrast(i, j) = point.contrast;
+            }
+        }
+
+        const Eigen::MatrixXi redDownsampled = downsampleAndRound(r, downsamplingFactor);
+        const Eigen::MatrixXi greenDownsampled = downsampleAndRound(g, downsamplingFactor);
+        const Eigen::MatrixXi blueDownsampled = downsampleAndRound(b, downsamplingFactor);
+
+        const auto isNotNaN = [](const float f) { return std::isnan(f) ? 0.0f : 1.0f; };
+        const Eigen::MatrixXf contrastNulled =
+            z.unaryExpr(isNotNaN).cwiseProduct(contrast.unaryExpr([](const float f) { return nanToZero(f); }));
+        const Eigen::MatrixXf contrastWeight = gridSum(contrastNulled, downsamplingFactor);
+
+        const Eigen::MatrixXf xDownsampled =
+            gridSum(x.cwiseProduct(contrastNulled), downsamplingFactor).cwiseQuotient(contrastWeight);
+        const Eigen::MatrixXf yDownsampled =
+            gridSum(y.cwiseProduct(contrastNulled), downsamplingFactor).cwiseQuotient(contrastWeight);
+        const Eigen::MatrixXf zDownsampled =
+            gridSum(z.cwiseProduct(contrastNulled), downsamplingFactor).cwiseQuotient(contrastWeight);
+        const Eigen::MatrixXf contrastDownsampled =
+            gridSum(contrast.cwiseProduct(contrastNulled), downsamplingFactor).cwiseQuotient(contrastWeight);
+
+        Zivid::PointCloud pointCloudDownsampled(redDownsampled.rows(), redDownsampled.cols());
+        for(Eigen::Index i = 0; i < redDownsampled.rows(); i++)
+        {
+            for(Eigen::Index j = 0; j < redDownsampled.cols(); j++)
+            {
+                auto &point = pointCloudDownsampled(i, j);
+                point.setRgb(redDownsampled(i, j), greenDownsampled(i, j), blueDownsampled(i, j));
+                point.setContrast(contrastDownsampled(i, j));
+                point.x = xDownsampled(i, j);
+                point.y = yDownsampled(i, j);
+                point.z = zDownsampled(i, j);
+            }
+        }
+        return pointCloudDownsampled;
+    }
+
+    // As in UtilizeEyeInHandCalibration: camera frame points to the robot base frame
+    void transformToBaseFrame(const Zivid::PointCloud &pointCloud,
+                              const Eigen::Affine3f &baseToCamera,
+                              Eigen::Matrix3Xf &pointsInBaseFrame)
+    {
+        pointsInBaseFrame.resize(3, static_cast<Eigen::Index>(pointCloud.size()));
+        for(size_t i = 0; i < pointCloud.size(); i++)
+        {
+            const auto &point = pointCloud(i);
+            pointsInBaseFrame.col(static_cast<Eigen::Index>(i)) =
+                baseToCamera * Eigen::Vector3f(point.x, point.y, point.z);
+        }
+    }
+
+    const int postProcessingDownsamplingFactor = 4;
+
+    bool canDownsample(const Zivid::PointCloud &pointCloud, const int downsamplingFactor)
+    {
+        return pointCloud.height() % downsamplingFactor == 0 && pointCloud.width() % downsamplingFactor == 0;
+    }
+
+    // An arbitrary hand-eye transform, the cost of the transform does not depend on its value
+    Eigen::Affine3f makeExampleBaseToCamera()
+    {
+        return Eigen::Translation3f(250.0f, -120.0f, 800.0f)
+               * Eigen::AngleAxisf(3.0f, Eigen::Vector3f(0.1f, 0.99f, 0.05f).normalized());
+    }
+#endif
+
+    void benchmarkPostProcessing(Zivid::Camera &camera, const BenchmarkOptions &options, BenchmarkResults &results)
+    {
+        printHeaderLine(options.numConversions, { "Running host-side conversions ", " times each:" });
+
+        const auto frame = camera.capture();
+        const auto pointCloud = frame.getPointCloud();
+        const auto numPoints = pointCloud.size();
+        std::cout << "  point cloud = " << pointCloud.width() << " x " << pointCloud.height() << " (" << numPoints
+                  << " points)" << std::endl;
+
+        const MemoryProbe memoryProbe;
+        std::vector<Measurement> measurements;
+        std::vector<std::string> unavailable;
+
+#ifdef BENCHMARK_WITH_PCL
+        pcl::PointCloud<pcl::PointXYZRGB> pclCloud;
+        measurements.push_back(benchmarkConversion("PointCloud to PCL", numPoints, options, results.trace, [&]() {
+            Utils::convertToPCL(pointCloud, pclCloud, Utils::CloudLayout::organized);
+        }));
+#else
+        unavailable.emplace_back("PointCloud to PCL (PCL)");
+#endif
+
+#ifdef BENCHMARK_WITH_OPENCV
+        OpenCVImages images;
+        measurements.push_back(benchmarkConversion("PointCloud to cv::Mat", numPoints, options, results.trace, [&]() {
+            images = convertToOpenCV(pointCloud);
+        }));
+        cv::Mat depthMap;
+        measurements.push_back(benchmarkConversion("Depth map coloring", numPoints, options, results.trace, [&]() {
+            depthMap = colorDepthMap(images.z, pointCloud);
+        }));
+#else
+        unavailable.emplace_back("PointCloud to cv::Mat (OpenCV)");
+        unavailable.emplace_back("Depth map coloring (OpenCV)");
+#endif
+
+#ifdef BENCHMARK_WITH_EIGEN3
+        if(canDownsample(pointCloud, postProcessingDownsamplingFactor))
+        {
+            Zivid::PointCloud downsampled;
+            measurements.push_back(benchmarkConversion("Downsample by 4", numPoints, options, results.trace, [&]() {
+                downsampled = downsample(pointCloud, postProcessingDownsamplingFactor);
+            }));
+        }
+        else
+        {
+            unavailable.emplace_back("Downsample (resolution not divisible by 4)");
+        }
+
+        const Eigen::Affine3f baseToCamera = makeExampleBaseToCamera();
+        Eigen::Matrix3Xf pointsInBaseFrame;
+        measurements.push_back(benchmarkConversion("Transform to base frame", numPoints, options, results.trace, [&]() {
+            transformToBaseFrame(pointCloud, baseToCamera, pointsInBaseFrame);
+        }));
+#else
+        unavailable.emplace_back("Downsample (Eigen)");
+        unavailable.emplace_back("Transform to base frame (Eigen)");
+#endif
+
+        for(const auto &conversion : unavailable)
+        {
+            std::cout << "  Not built: " << conversion << std::endl;
+        }
+        if(!measurements.empty()) reportResults(measurements, memoryProbe, results);
+    }
+
+    // Outputs of the host-side pipeline, one per worker so that workers never write to shared memory
+    struct HostPipelineOutputs
+    {
+#ifdef BENCHMARK_WITH_PCL
+        pcl::PointCloud<pcl::PointXYZRGB> pclCloud;
+#endif
+#ifdef BENCHMARK_WITH_OPENCV
+        OpenCVImages images;
+        cv::Mat depthMap;
+#endif
+#ifdef BENCHMARK_WITH_EIGEN3
+        Zivid::PointCloud downsampled;
+        Eigen::Matrix3Xf pointsInBaseFrame;
+#endif
+    };
+
+    std::vector<std::string> getHostPipelineSteps(const Zivid::PointCloud &pointCloud)
+    {
+        std::vector<std::string> steps;
+#ifdef BENCHMARK_WITH_PCL
+        steps.emplace_back("PCL");
+#endif
+#ifdef BENCHMARK_WITH_OPENCV
+        steps.emplace_back("cv::Mat");
+        steps.emplace_back("depth map");
+#endif
+#ifdef BENCHMARK_WITH_EIGEN3
+        if(canDownsample(pointCloud, postProcessingDownsamplingFactor)) steps.emplace_back("downsample");
+        steps.emplace_back("transform");
+#else
+        static_cast<void>(pointCloud);
+#endif
+        return steps;
+    }
+
+    // The post-processing conversions run back to back, as an application would do for each frame
+    void runHostPipeline(const Zivid::PointCloud &pointCloud, HostPipelineOutputs &outputs)
+    {
+#ifdef BENCHMARK_WITH_PCL
+        // Every worker converts on its own thread, since the scaling section already runs one worker per thread
+        Utils::convertToPCL(pointCloud, outputs.pclCloud, Utils::CloudLayout::organized, 1);
+#endif
+#ifdef BENCHMARK_WITH_OPENCV
+        outputs.images = convertToOpenCV(pointCloud);
+        outputs.depthMap = colorDepthMap(outputs.images.z, pointCloud);
+#endif
+#ifdef BENCHMARK_WITH_EIGEN3
+        if(canDownsample(pointCloud, postProcessingDownsamplingFactor))
+        {
+            outputs.downsampled = downsample(pointCloud, postProcessingDownsamplingFactor);
+        }
+        transformToBaseFrame(pointCloud, makeExampleBaseToCamera(), outputs.pointsInBaseFrame);
+#endif
+#if !defined(BENCHMARK_WITH_PCL) && !defined(BENCHMARK_WITH_OPENCV) && !defined(BENCHMARK_WITH_EIGEN3)
+        static_cast<void>(pointCloud);
+        static_cast<void>(outputs);
+#endif
+    }
+
+    Zivid::PointCloud copyPointCloud(const Zivid::PointCloud &pointCloud)
+    {
+        Zivid::PointCloud copy(pointCloud.height(), pointCloud.width());
+        std::copy(pointCloud.dataPtr(), pointCloud.dataPtr() + pointCloud.size(), copy.dataPtr());
+        return copy;
+    }
+
+    // 1, 2, 4, ... up to and including maxThreads
+    std::vector<size_t> makeThreadCounts(const size_t maxThreads)
+    {
+        std::vector<size_t> threadCounts;
+        for(size_t numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        {
+            threadCounts.push_back(numThreads);
+        }
+        threadCounts.push_back(maxThreads);
+        return threadCounts;
+    }
+
+    struct WorkerTimes
+    {
+        std::vector<HighResClock::time_point> begins;
+        std::vector<Duration> durations;
+    };
+
+    // Runs the pipeline numIterations times on the worker's own copy once all workers are ready
+    WorkerTimes runHostPipelineWorker(const Zivid::PointCloud &pointCloud,
+                                      const size_t numIterations,
+                                      std::atomic<size_t> &numReady,
+                                      const std::atomic<bool> &start)
+    {
+        HostPipelineOutputs outputs;
+        WorkerTimes times;
+        times.begins.reserve(numIterations);
+        times.durations.reserve(numIterations);
+
+        numReady++;
+        while(!start)
+        {
+            std::this_thread::yield();
+        }
+
+        for(size_t i = 0; i < numIterations; i++)
+        {
+            const auto beforePipeline = HighResClock::now();
+            runHostPipeline(pointCloud, outputs);
+            const auto afterPipeline = HighResClock::now();
+
+            times.begins.push_back(beforePipeline);
+            times.durations.push_back(afterPipeline - beforePipeline);
+        }
+        return times;
+    }
+
+    struct ScalingResult
+    {
+        size_t numThreads;
+        double framesPerSecond;
+        double mpointsPerSecond;
+    };
+
+    void printScalingResults(const std::vector<ScalingResult> &scalingResults)
+    {
+        printPrimarySeparationLine();
+        std::cout << "Aggregate host-side throughput:" << std::endl;
+        printSecondarySeparationLine();
+        printFormated({ "  Threads:", "Frames/s", "Mpoints/s    Efficiency" });
+        const auto &singleThreaded = scalingResults.front();
+        for(const auto &scalingResult : scalingResults)
+        {
+            // Throughput relative to perfect scaling of the single threaded throughput
+            const double perfectScaling =
+                static_cast<double>(scalingResult.numThreads) * singleThreaded.framesPerSecond;
+            const double efficiency = scalingResult.framesPerSecond / perfectScaling;
+            std::ostringstream mpointsAndEfficiency;
+            mpointsAndEfficiency << std::left << std::setw(13)
+                                 << valueToStringWithPrecision(scalingResult.mpointsPerSecond, 1)
+                                 << valueToStringWithPrecision(100.0 * efficiency, 0) + " %";
+            printFormated({ "  " + std::to_string(scalingResult.numThreads) + ":",
+                            valueToStringWithPrecision(scalingResult.framesPerSecond, 1),
+                            mpointsAndEfficiency.str() });
+        }
+    }
+
+    // Runs the host-side pipeline on 1 to maxThreads threads at the same time, each on its own copy of the frame
+    void benchmarkScaling(const BenchmarkOptions &options, BenchmarkResults &results)
+    {
+        const size_t maxThreads =
+            options.maxThreads > 0 ? options.maxThreads : std::max(std::thread::hardware_concurrency(), 1U);
+        printHeaderLine(options.numConversions, { "Running host-side pipeline ", " times per thread:" });
+
+        // The same frame loaded from a ZDF in every camera mode, so that runs on different machines are comparable
+        const Zivid::Frame frame(options.scalingFileName);
+        const auto pointCloud = frame.getPointCloud();
+        const auto numPoints = pointCloud.size();
+        const auto steps = getHostPipelineSteps(pointCloud);
+        if(steps.empty())
+        {
+            std::cout << "  Not built: host-side pipeline (PCL, OpenCV or Eigen)" << std::endl;
+            return;
+        }
+        std::string stepList = "{ ";
+        for(size_t i = 0; i < steps.size(); i++)
+        {
+            stepList += steps.at(i) + (i + 1 != steps.size() ? ", " : " }");
+        }
+        std::cout << "  file = " << options.scalingFileName << std::endl;
+        std::cout << "  point cloud = " << pointCloud.width() << " x " << pointCloud.height() << " (" << numPoints
+                  << " points)" << std::endl;
+        std::cout << "  pipeline = " << stepList << std::endl;
+        std::cout << "  threads = 1 to " << maxThreads << std::endl;
+
+        std::vector<Zivid::PointCloud> copies;
+        for(size_t i = 0; i < maxThreads; i++)
+        {
+            copies.push_back(copyPointCloud(pointCloud));
+        }
+        HostPipelineOutputs warmupOutputs;
+        for(size_t i = 0; i < options.numWarmups; i++)
+        {
+            runHostPipeline(copies.front(), warmupOutputs);
+        }
+
+        const MemoryProbe memoryProbe;
+        const std::string section = "Scaling";
+        std::vector<Measurement> measurements;
+        std::vector<ScalingResult> scalingResults;
+        for(const auto numThreads : makeThreadCounts(maxThreads))
+        {
+            std::atomic<size_t> numReady{ 0 };
+            std::atomic<bool> start{ false };
+            std::vector<std::future<WorkerTimes>> workers;
+            for(size_t i = 0; i < numThreads; i++)
+            {
+                workers.push_back(std::async(std::launch::async,
+                                             runHostPipelineWorker,
+                                             std::cref(copies.at(i)),
+                                             options.numConversions,
+                                             std::ref(numReady),
+                                             std::cref(start)));
+            }
+            while(numReady < numThreads)
+            {
+                std::this_thread::yield();
+            }
+
+            const auto beforeStart = HighResClock::now();
+            start = true;
+            std::vector<WorkerTimes> workerTimes;
+            for(auto &worker : workers)
+            {
+                workerTimes.push_back(worker.get());
+            }
+            const auto afterAll = HighResClock::now();
+
+            const auto name = std::to_string(numThreads) + (numThreads == 1 ? " thread" : " threads");
+            std::vector<Duration> latencies;
+            for(size_t i = 0; i < workerTimes.size(); i++)
+            {
+                const auto &times = workerTimes.at(i);
+                latencies.insert(latencies.end(), times.durations.begin(), times.durations.end());
+                for(size_t j = 0; j < times.begins.size(); j++)
+                {
+                    results.trace.record(name.c_str(),
+                                         "postprocessing",
+                                         section.c_str(),
+                                         times.begins.at(j),
+                                         times.begins.at(j) + times.durations.at(j),
+                                         i + 2);
+                }
             }
+            measurements.push_back({ section, name, latencies, numPoints });
 
-            allDurations.push_back(computeMedianDuration(durationsPerFormat));
-            allDurations.push_back(computeAverageDuration(durationsPerFormat));
+            const double seconds = toMilliseconds(afterAll - beforeStart) / 1000.0;
+            const auto numFrames = static_cast<double>(numThreads * options.numConversions);
+            scalingResults.push_back(
+                { numThreads, numFrames / seconds, numFrames * static_cast<double>(numPoints) / seconds / 1e6 });
         }
-        printSaveResults(allDurations);
+
+        // Latency and throughput per thread, then the aggregate over all threads
+        reportResults(measurements, memoryProbe, results);
+        printScalingResults(scalingResults);
     }
 } // namespace
 
-int main()
+int main(int argc, char **argv)
 {
     try
     {
-        Zivid::Application zivid;
+        BenchmarkOptions options;
+        std::vector<std::string> sections;
+        size_t numIterations = 0;
+        double timeBudgetSeconds = 0.0;
+        std::vector<std::string> hdrSetTexts;
+        std::string jsonFileName;
+        std::string csvFileName;
+        std::string fileCameraName;
+        std::string traceFileName;
+        std::string baselineFileName;
+        std::string currentFileName;
+        bool compareOnly = false;
+        ComparisonOptions comparisonOptions;
+        auto comparisonOptionsCli =
+            (clipp::option("--threshold") & clipp::value("percent", comparisonOptions.regressionThreshold),
+             clipp::option("--alpha") & clipp::value("level", comparisonOptions.significanceLevel));
+        auto compareMode = (clipp::command("compare").set(compareOnly),
+                            clipp::value("baseline", baselineFileName),
+                            clipp::value("current", currentFileName),
+                            comparisonOptionsCli);
+        auto runMode = (clipp::option("--sections") & clipp::values("section", sections),
+                    clipp::option("--iterations") & clipp::value("count", numIterations),
+                    clipp::option("--connects") & clipp::value("count", options.numConnects),
+                    clipp::option("--frames-3d") & clipp::value("count", options.numFrames3D),
+                    clipp::option("--frames-2d") & clipp::value("count", options.numFrames2D),
+                    clipp::option("--frames-save") & clipp::value("count", options.numFramesSave),
+                    clipp::option("--conversions") & clipp::value("count", options.numConversions),
+                    clipp::option("--warmups") & clipp::value("count", options.numWarmups),
+                    clipp::option("--sweep-frames") & clipp::value("count", options.maxSweepFrames),
+                    clipp::option("--max-threads") & clipp::value("count", options.maxThreads),
+                    clipp::option("--sync-saves").set(options.syncSaves),
+                    clipp::option("--cold-cache").set(options.coldPageCache),
+                    clipp::option("--time-budget") & clipp::value("seconds", timeBudgetSeconds),
+                    clipp::repeatable(clipp::option("--hdr") & clipp::value("iris[:exposure],...", hdrSetTexts)),
+                    clipp::option("--json") & clipp::value("file", jsonFileName),
+                    clipp::option("--csv") & clipp::value("file", csvFileName),
+                    clipp::option("--trace") & clipp::value("file", traceFileName),
+                    clipp::option("--file-camera") & clipp::value("zdf", fileCameraName),
+                    clipp::option("--scaling-zdf") & clipp::value("zdf", options.scalingFileName),
+                    clipp::option("--baseline") & clipp::value("file", baselineFileName),
+                    comparisonOptionsCli);
+        auto cli = (compareMode | runMode);
+
+        if(!parse(argc, argv, cli))
+        {
+            std::cout << clipp::usage_lines(cli, *argv) << std::endl;
+            std::cout << "Sections:";
+            for(const auto &section : allSections()) std::cout << " " << section;
+            std::cout << std::endl << "Default sections:";
+            for(const auto &section : defaultSections()) std::cout << " " << section;
+            std::cout << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if(compareOnly)
+        {
+            const auto current = readJsonResults(currentFileName);
+            const auto numRegressions = compareWithBaseline(
+                readJsonResults(baselineFileName), current.systemInfo, current.results.measurements, comparisonOptions);
+            return numRegressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        if(!sections.empty()) options.sections = sections;
+        const auto knownSections = allSections();
+        for(const auto &section : options.sections)
+        {
+            if(std::find(knownSections.begin(), knownSections.end(), section) == knownSections.end())
+            {
+                throw std::invalid_argument("Unknown section: " + section);
+            }
+        }
+        if(numIterations > 0)
+        {
+            options.numConnects = numIterations;
+            options.numFrames3D = numIterations;
+            options.numFrames2D = numIterations;
+            options.numFramesSave = numIterations;
+            options.numConversions = numIterations;
+        }
+        if(options.numConnects == 0 || options.numFrames3D == 0 || options.numFrames2D == 0
+           || options.numFramesSave == 0 || options.numConversions == 0)
+        {
+            throw std::invalid_argument("Every section needs at least one iteration");
+        }
+        if(isSelected(options, "hdrsweep") && options.maxSweepFrames < 2)
+        {
+            throw std::invalid_argument("The HDR sweep needs at least two frame counts");
+        }
+        if((options.syncSaves || options.coldPageCache) && !isFileFlushSupported())
+        {
+            throw std::invalid_argument("--sync-saves and --cold-cache are only supported on Linux");
+        }
+        options.timeBudget =
+            std::chrono::duration_cast<Duration>(std::chrono::duration<double>{ timeBudgetSeconds });
 
-        auto camera = getFirstCamera(zivid);
+        Zivid::Application zivid;
 
-        const size_t numConnects = 10;
-        const size_t numFrames3D = 20;
-        const size_t numFrames2D = 50;
-        const size_t numFramesSave = 10;
+        // A file camera replays a ZDF without hardware, so the host side can be benchmarked on build servers
+        const bool useFileCamera = !fileCameraName.empty();
+        if(options.scalingFileName.empty())
+        {
+            options.scalingFileName = useFileCamera ? fileCameraName : "Zivid3D.zdf";
+        }
+        auto camera = useFileCamera ? zivid.createFileCamera(fileCameraName) : getFirstCamera(zivid);
+        const auto systemInfo = makeSystemInfo(camera, fileCameraName);
+        printZividInfo(systemInfo);
 
         const size_t exposureTime = getMinExposureTime(camera.modelName());
-        const std::vector<size_t> exposureTimeOneFrame{ exposureTime };
-        const std::vector<size_t> exposureTimeTwoFrames{ exposureTime, exposureTime };
-        const std::vector<size_t> exposureTimeThreeFrames{ exposureTime, exposureTime, exposureTime };
-
-        const std::vector<unsigned int> oneIris{ 21U };
-        const std::vector<unsigned int> twoIrises{ 17U, 27U };
-        const std::vector<unsigned int> threeIrises{ 14U, 21U, 35U };
-
-        benchmarkConnect(camera, numConnects);
-        camera.connect();
-        benchmarkAssistedCapture3D(camera, numFrames3D);
-        benchmarkCapture3DAndFilters(camera, oneIris, exposureTimeOneFrame, numFrames3D);
-        benchmarkCapture3D(camera, makeSettingsVector(twoIrises, exposureTimeTwoFrames, false, false), numFrames3D);
-        benchmarkCapture3DAndFilters(camera, threeIrises, exposureTimeThreeFrames, numFrames3D);
-        benchmarkCapture2D(camera, makeSettings2D(exposureTime), numFrames2D);
-        benchmarkSave(camera, numFramesSave);
+        for(const auto &hdrSetText : hdrSetTexts)
+        {
+            options.hdrSets.push_back(parseHDRSet(hdrSetText, exposureTime));
+        }
+        if(options.hdrSets.empty())
+        {
+            options.hdrSets = makeDefaultHDRSets(exposureTime);
+        }
+
+        BenchmarkResults results;
+        if(!traceFileName.empty()) results.trace.enable();
+        if(useFileCamera)
+        {
+            if(isSelected(options, "connect")) printSkippedSection("connect and disconnect");
+            if(isSelected(options, "assisted")) printSkippedSection("assisted capture");
+        }
+        else
+        {
+            if(isSelected(options, "connect")) benchmarkConnect(camera, options, results);
+            camera.connect();
+            if(isSelected(options, "assisted")) benchmarkAssistedCapture3D(camera, options, results);
+        }
+        for(const auto &hdrSet : options.hdrSets)
+        {
+            if(isSelected(options, "filters"))
+            {
+                benchmarkCapture3DAndFilters(camera, hdrSet, options, results);
+            }
+            else if(isSelected(options, "capture3d"))
+            {
+                benchmarkCapture3D(
+                    camera, makeSettingsVector(hdrSet.irises, hdrSet.exposureTimes, false, false), options, results);
+            }
+        }
+        if(isSelected(options, "hdrsweep")) benchmarkHDRSweep(camera, exposureTime, options, results);
+        if(isSelected(options, "capture2d"))
+        {
+            if(useFileCamera)
+            {
+                printSkippedSection("2D capture");
+            }
+            else
+            {
+                benchmarkCapture2D(camera, makeSettings2D(exposureTime), options, results);
+            }
+        }
+        if(isSelected(options, "save")) benchmarkSave(camera, options, results);
+        if(isSelected(options, "postprocessing")) benchmarkPostProcessing(camera, options, results);
+        if(isSelected(options, "scaling")) benchmarkScaling(options, results);
+
+        if(!jsonFileName.empty())
+        {
+            writeJsonResults(jsonFileName, systemInfo, results);
+            std::cout << "Results written to " << jsonFileName << std::endl;
+        }
+        if(!csvFileName.empty())
+        {
+            writeCsvResults(csvFileName, results);
+            std::cout << "Results written to " << csvFileName << std::endl;
+        }
+        if(!traceFileName.empty())
+        {
+            writeTrace(traceFileName, results.trace);
+            std::cout << "Trace written to " << traceFileName << std::endl;
+        }
+        if(!baselineFileName.empty())
+        {
+            const auto numRegressions = compareWithBaseline(
+                readJsonResults(baselineFileName), systemInfo, results.measurements, comparisonOptions);
+            if(numRegressions > 0) return EXIT_FAILURE;
+        }
     }
     catch(const std::exception &e)
     {
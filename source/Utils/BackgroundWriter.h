@@ -0,0 +1,142 @@
+/*
+Background writer shared by the capture samples.
+
+Saving a frame takes as long as the disk needs, which is often longer than the
+next capture. The writer runs the save jobs on its own worker threads, so that
+the capture loop only has to hand the job over and can capture again right away.
+
+At most maxQueuedJobs jobs wait in the queue. When the queue is full, submit()
+either blocks until a worker has taken a job (OverflowPolicy::block), or drops
+the new job (OverflowPolicy::dropNewest), so that a slow disk cannot make the
+queue, and the memory held by queued frames, grow without bound.
+
+Every job reports its completion through the returned future: get() returns
+when the job has finished, and rethrows the exception of a job that failed or
+was dropped.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Utils
+{
+    class BackgroundWriter
+    {
+    public:
+        enum class OverflowPolicy
+        {
+            block,
+            dropNewest
+        };
+
+        BackgroundWriter(size_t numWorkers, size_t maxQueuedJobs, OverflowPolicy policy)
+            : m_maxQueuedJobs{ maxQueuedJobs }
+            , m_policy{ policy }
+        {
+            if(numWorkers == 0 || maxQueuedJobs == 0)
+            {
+                throw std::invalid_argument("The background writer needs at least one worker and one queue slot");
+            }
+
+            for(size_t i = 0; i < numWorkers; ++i)
+            {
+                m_workers.emplace_back([this] { runWorker(); });
+            }
+        }
+
+        BackgroundWriter(const BackgroundWriter &) = delete;
+        BackgroundWriter &operator=(const BackgroundWriter &) = delete;
+
+        ~BackgroundWriter()
+        {
+            /*
+			Finishes the jobs that are already queued before the workers are joined,
+			so that no accepted frame is lost when the writer goes out of scope.
+			*/
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_jobQueued.notify_all();
+            for(auto &worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        std::future<void> submit(std::function<void()> job)
+        {
+            std::packaged_task<void()> task(std::move(job));
+            auto future = task.get_future();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if(m_queue.size() >= m_maxQueuedJobs)
+            {
+                if(m_policy == OverflowPolicy::dropNewest)
+                {
+                    ++m_numDropped;
+                    lock.unlock();
+
+                    std::promise<void> dropped;
+                    dropped.set_exception(std::make_exception_ptr(
+                        std::runtime_error("The write queue was full, so the job was dropped")));
+                    return dropped.get_future();
+                }
+                m_jobTaken.wait(lock, [this] { return m_queue.size() < m_maxQueuedJobs; });
+            }
+            m_queue.push_back(std::move(task));
+            lock.unlock();
+
+            m_jobQueued.notify_one();
+            return future;
+        }
+
+        size_t numDropped() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_numDropped;
+        }
+
+    private:
+        void runWorker()
+        {
+            while(true)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobQueued.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if(m_queue.empty())
+                {
+                    return;
+                }
+
+                auto task = std::move(m_queue.front());
+                m_queue.pop_front();
+                lock.unlock();
+
+                m_jobTaken.notify_one();
+                task();
+            }
+        }
+
+        const size_t m_maxQueuedJobs;
+        const OverflowPolicy m_policy;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_jobQueued;
+        std::condition_variable m_jobTaken;
+        std::deque<std::packaged_task<void()>> m_queue;
+        size_t m_numDropped = 0;
+        bool m_stopping = false;
+        std::vector<std::thread> m_workers;
+    };
+} // namespace Utils
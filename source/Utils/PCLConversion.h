@@ -0,0 +1,141 @@
+/*
+Conversion of Zivid point clouds to PCL point clouds, shared by the samples.
+
+The points are copied straight from the Zivid point cloud into the given
+pcl::PointCloud, split into contiguous ranges that are converted in parallel.
+The cloud is filled in place, so a cloud owned by a Ptr needs no further copy,
+and its storage is reused when it already has the right size.
+
+pcl::PointXYZRGB is supported out of the box. For another point type, declare
+a setPoint(const Zivid::Point &, PointT &) overload next to the point type, so
+that the conversion finds it through argument-dependent lookup.
+*/
+
+#pragma once
+
+#include <Zivid/Zivid.h>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <ParallelRanges.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace Utils
+{
+    enum class CloudLayout
+    {
+        organized,
+        dense
+    };
+
+    inline void setPoint(const Zivid::Point &source, pcl::PointXYZRGB &destination)
+    {
+        destination.x = source.x;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+        destination.y = source.y;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+        destination.z = source.z;       // NOLINT(cppcoreguidelines-pro-type-union-access)
+        destination.r = source.red();   // NOLINT(cppcoreguidelines-pro-type-union-access)
+        destination.g = source.green(); // NOLINT(cppcoreguidelines-pro-type-union-access)
+        destination.b = source.blue();  // NOLINT(cppcoreguidelines-pro-type-union-access)
+    }
+
+    inline size_t countValidPoints(const Zivid::Point *begin, const Zivid::Point *end)
+    {
+        return static_cast<size_t>(
+            std::count_if(begin, end, [](const Zivid::Point &point) { return !std::isnan(point.z); }));
+    }
+
+    template<typename PointT>
+    void copyPointRange(const Zivid::Point *begin, const Zivid::Point *end, PointT *destination)
+    {
+        /*
+		A branch-free loop over contiguous memory, so that the compiler can vectorize the deinterleaving of
+		the Zivid points into the PCL point layout.
+		*/
+
+        const auto numPoints = static_cast<size_t>(end - begin);
+        for(size_t i = 0; i < numPoints; ++i)
+        {
+            setPoint(begin[i], destination[i]);
+        }
+    }
+
+    template<typename PointT>
+    void copyValidPointRange(const Zivid::Point *begin, const Zivid::Point *end, PointT *destination)
+    {
+        for(const Zivid::Point *point = begin; point != end; ++point)
+        {
+            if(std::isnan(point->z)) continue;
+
+            setPoint(*point, *destination);
+            ++destination;
+        }
+    }
+
+    template<typename PointT>
+    void convertToPCL(const Zivid::PointCloud &pointCloud,
+                      pcl::PointCloud<PointT> &cloud,
+                      const CloudLayout layout,
+                      const size_t numRanges)
+    {
+        /*
+		The organized layout keeps one point per pixel, with NaN coordinates for missing points. The dense
+		layout keeps only the valid points: every range counts its valid points first, so that the ranges can
+		then write their points to their final positions in parallel. Pass numRanges = 1 to convert on the
+		calling thread only, for example when the caller already runs one conversion per core.
+		*/
+
+        const Zivid::Point *source = pointCloud.dataPtr();
+        const size_t numPoints = pointCloud.size();
+
+        if(layout == CloudLayout::organized)
+        {
+            cloud.width = static_cast<uint32_t>(pointCloud.width());
+            cloud.height = static_cast<uint32_t>(pointCloud.height());
+            cloud.is_dense = false;
+            cloud.points.resize(numPoints);
+
+            PointT *destination = cloud.points.data();
+            const auto copyRange = [source, destination](size_t, const size_t begin, const size_t end) {
+                copyPointRange(source + begin, source + end, destination + begin);
+            };
+            forEachRange(numPoints, numRanges, copyRange);
+            return;
+        }
+
+        std::vector<size_t> numValidPerRange(numRanges);
+        const auto countRange = [source, &numValidPerRange](const size_t range, const size_t begin, const size_t end) {
+            numValidPerRange.at(range) = countValidPoints(source + begin, source + end);
+        };
+        forEachRange(numPoints, numRanges, countRange);
+
+        std::vector<size_t> rangeOffsets(numRanges, 0);
+        std::partial_sum(numValidPerRange.begin(), numValidPerRange.end() - 1, rangeOffsets.begin() + 1);
+        const size_t numValid = rangeOffsets.back() + numValidPerRange.back();
+
+        cloud.width = static_cast<uint32_t>(numValid);
+        cloud.height = 1;
+        cloud.is_dense = true;
+        cloud.points.resize(numValid);
+
+        PointT *destination = cloud.points.data();
+        const auto copyRange = [source, destination, &rangeOffsets](const size_t range,
+                                                                    const size_t begin,
+                                                                    const size_t end) {
+            copyValidPointRange(source + begin, source + end, destination + rangeOffsets.at(range));
+        };
+        forEachRange(numPoints, numRanges, copyRange);
+    }
+
+    template<typename PointT>
+    void convertToPCL(const Zivid::PointCloud &pointCloud, pcl::PointCloud<PointT> &cloud, const CloudLayout layout)
+    {
+        convertToPCL(pointCloud, cloud, layout, computeNumRanges(pointCloud.size()));
+    }
+} // namespace Utils
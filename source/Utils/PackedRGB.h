@@ -0,0 +1,22 @@
+/*
+Packing of the color of a Zivid point into one 32-bit value, shared by the samples.
+
+The layout is the one of the rgb field of pcl::PointXYZRGB and of PCD and PLY
+files: alpha in bits 24-31, red in bits 16-23, green in bits 8-15 and blue in
+bits 0-7. Zivid points carry no transparency, so alpha is always 255.
+*/
+
+#pragma once
+
+#include <Zivid/Zivid.h>
+
+#include <cstdint>
+
+namespace Utils
+{
+    inline uint32_t packRGB(const Zivid::Point &point)
+    {
+        return (255U << 24U) | (static_cast<uint32_t>(point.red()) << 16U)
+               | (static_cast<uint32_t>(point.green()) << 8U) | static_cast<uint32_t>(point.blue());
+    }
+} // namespace Utils
@@ -0,0 +1,46 @@
+/*
+Splitting of point clouds into contiguous ranges that are processed in parallel, shared by the samples.
+
+A point cloud is split into one range per hardware thread, with at least minPointsPerRange points per range,
+so that small clouds are not spread over more threads than is worth the cost of starting them. Every range is
+processed on its own thread, and the calling thread handles the first range.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+    inline size_t computeNumRanges(const size_t numPoints)
+    {
+        const size_t minPointsPerRange = 16384;
+        return std::max<size_t>(1,
+                                std::min<size_t>(std::thread::hardware_concurrency(), numPoints / minPointsPerRange));
+    }
+
+    // Calls rangeFunction(range, begin, end) for each of numRanges contiguous ranges of the points
+    template<typename RangeFunction>
+    void forEachRange(const size_t numPoints, const size_t numRanges, RangeFunction rangeFunction)
+    {
+        const size_t pointsPerRange = (numPoints + numRanges - 1) / numRanges;
+
+        std::vector<std::thread> workers;
+        for(size_t range = 1; range < numRanges; range++)
+        {
+            const auto begin = std::min(range * pointsPerRange, numPoints);
+            const auto end = std::min(begin + pointsPerRange, numPoints);
+            workers.emplace_back(rangeFunction, range, begin, end);
+        }
+
+        rangeFunction(0, 0, std::min(pointsPerRange, numPoints));
+
+        for(auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+} // namespace Utils
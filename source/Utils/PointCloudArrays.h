@@ -0,0 +1,117 @@
+/*
+Structure-of-arrays extraction of Zivid point clouds, shared by the samples.
+
+A Zivid point cloud stores every point as one record (x, y, z, contrast and
+rgba). Algorithms that work on one property at a time, such as filtering on z
+or averaging the contrast, run faster over separate contiguous arrays: every
+cache line loaded holds only the property in use, and the compiler can
+vectorize the loops over plain float arrays.
+
+extractArrays fills x, y, z, rgb, contrast and a valid mask in a single pass
+over the points, split into contiguous ranges that are processed in parallel.
+The colors are packed as in pcl::PointXYZRGB, see PackedRGB.h.
+The arrays are resized in place, so when the same PointCloudArrays is passed
+for every frame, the buffers are allocated once and then reused. Callers that
+manage their own memory can fill raw buffers through PointArrayBuffers instead.
+*/
+
+#pragma once
+
+#include <Zivid/Zivid.h>
+
+#include <PackedRGB.h>
+#include <ParallelRanges.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Utils
+{
+    // Caller-owned buffers that each hold at least as many elements as there are points
+    struct PointArrayBuffers
+    {
+        float *x;
+        float *y;
+        float *z;
+        uint32_t *rgb;
+        float *contrast;
+        uint8_t *valid;
+    };
+
+    struct PointCloudArrays
+    {
+        size_t width = 0;
+        size_t height = 0;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<uint32_t> rgb;
+        std::vector<float> contrast;
+        std::vector<uint8_t> valid;
+
+        size_t size() const
+        {
+            return x.size();
+        }
+
+        PointArrayBuffers buffers()
+        {
+            return PointArrayBuffers{ x.data(), y.data(), z.data(), rgb.data(), contrast.data(), valid.data() };
+        }
+    };
+
+    inline void extractArrayRange(const Zivid::Point *points,
+                                  const size_t begin,
+                                  const size_t end,
+                                  const PointArrayBuffers &buffers)
+    {
+        /*
+		One branch-free loop that reads every point once and writes all arrays. The copy is limited by memory
+		bandwidth, so one pass per range is faster than one loop per array. The buffer pointers are copied to
+		locals first, so that the stores to the arrays cannot be assumed to change them. Missing points keep
+		their NaN coordinates in the arrays and get 0 in the valid mask.
+		*/
+
+        float *x = buffers.x;
+        float *y = buffers.y;
+        float *z = buffers.z;
+        uint32_t *rgb = buffers.rgb;
+        float *contrast = buffers.contrast;
+        uint8_t *valid = buffers.valid;
+        for(size_t i = begin; i < end; ++i)
+        {
+            const auto &point = points[i];
+            x[i] = point.x;
+            y[i] = point.y;
+            z[i] = point.z;
+            rgb[i] = packRGB(point);
+            contrast[i] = point.contrast;
+            valid[i] = static_cast<uint8_t>(!std::isnan(point.z));
+        }
+    }
+
+    inline void extractArrays(const Zivid::Point *points, const size_t numPoints, const PointArrayBuffers &buffers)
+    {
+        const auto extractRange = [points, buffers](size_t, const size_t begin, const size_t end) {
+            extractArrayRange(points, begin, end, buffers);
+        };
+        forEachRange(numPoints, computeNumRanges(numPoints), extractRange);
+    }
+
+    inline void extractArrays(const Zivid::PointCloud &pointCloud, PointCloudArrays &arrays)
+    {
+        const size_t numPoints = pointCloud.size();
+        arrays.width = pointCloud.width();
+        arrays.height = pointCloud.height();
+        arrays.x.resize(numPoints);
+        arrays.y.resize(numPoints);
+        arrays.z.resize(numPoints);
+        arrays.rgb.resize(numPoints);
+        arrays.contrast.resize(numPoints);
+        arrays.valid.resize(numPoints);
+
+        extractArrays(pointCloud.dataPtr(), numPoints, arrays.buffers());
+    }
+} // namespace Utils
@@ -0,0 +1,50 @@
+/*
+Render loop for the PCL visualizer, shared by the PCL samples.
+
+Instead of polling wasStopped() in a tight loop, which keeps a core fully busy
+for as long as the window is open, the loop lets PCLVisualizer::spinOnce wait
+for window events until the next frame is due. The frame rate is capped at
+maxFramesPerSecond, and the CPU is left to capturing and processing in between.
+
+Before each frame the loop calls updateFunction, which may hand a new cloud to
+the visualizer (for example with updatePointCloud) to show a live stream.
+*/
+
+#pragma once
+
+#include <pcl/visualization/pcl_visualizer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace Utils
+{
+    template<typename UpdateFunction>
+    void runViewerLoop(pcl::visualization::PCLVisualizer &viewer,
+                       const double maxFramesPerSecond,
+                       UpdateFunction updateFunction)
+    {
+        if(maxFramesPerSecond <= 0.0)
+        {
+            throw std::invalid_argument("The viewer frame rate must be positive");
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const auto frameInterval =
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / maxFramesPerSecond));
+
+        auto nextFrame = Clock::now();
+        while(!viewer.wasStopped())
+        {
+            updateFunction();
+
+            // After a slow frame, start counting from now instead of rendering the missed frames back to back
+            nextFrame = std::max(nextFrame + frameInterval, Clock::now());
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(nextFrame - Clock::now());
+            viewer.spinOnce(std::max(1, static_cast<int>(remaining.count())));
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+} // namespace Utils